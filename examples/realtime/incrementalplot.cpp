@@ -1,40 +1,13 @@
 #include <qwt_plot.h>
 #include <qwt_plot_canvas.h>
 #include <qwt_plot_curve.h>
+#include <qwt_point_data.h>
 #include <qwt_symbol.h>
 #include <qwt_plot_directpainter.h>
 #include <qwt_painter.h>
 #include "incrementalplot.h"
 #include <qpaintengine.h>
 
-class CurveData: public QwtArraySeriesData<QPointF>
-{
-public:
-    CurveData()
-    {
-    }
-
-    virtual QRectF boundingRect() const
-    {
-        if ( d_boundingRect.width() < 0.0 )
-            d_boundingRect = qwtBoundingRect( *this );
-
-        return d_boundingRect;
-    }
-
-    inline void append( const QPointF &point )
-    {
-        d_samples += point;
-    }
-
-    void clear()
-    {
-        d_samples.clear();
-        d_samples.squeeze();
-        d_boundingRect = QRectF( 0.0, 0.0, -1.0, -1.0 );
-    }
-};
-
 IncrementalPlot::IncrementalPlot( QWidget *parent ):
     QwtPlot( parent ),
     d_curve( NULL )
@@ -50,7 +23,7 @@ IncrementalPlot::IncrementalPlot( QWidget *parent ):
     }
 
     d_curve = new QwtPlotCurve( "Test Curve" );
-    d_curve->setData( new CurveData() );
+    d_curve->setData( new QwtPointArrayData() );
     showSymbols( true );
 
     d_curve->attach( this );
@@ -65,8 +38,9 @@ IncrementalPlot::~IncrementalPlot()
 
 void IncrementalPlot::appendPoint( const QPointF &point )
 {
-    CurveData *data = static_cast<CurveData *>( d_curve->data() );
-    data->append( point );
+    QwtPointArrayData *data = 
+        static_cast<QwtPointArrayData *>( d_curve->data() );
+    data->append( point.x(), point.y() );
 
     const bool doClip = !canvas()->testAttribute( Qt::WA_PaintOnScreen );
     if ( doClip )
@@ -99,7 +73,8 @@ void IncrementalPlot::appendPoint( const QPointF &point )
 
 void IncrementalPlot::clearPoints()
 {
-    CurveData *data = static_cast<CurveData *>( d_curve->data() );
+    QwtPointArrayData *data = 
+        static_cast<QwtPointArrayData *>( d_curve->data() );
     data->clear();
 
     replot();
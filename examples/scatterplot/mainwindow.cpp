@@ -1,5 +1,6 @@
 #include "mainwindow.h"
 #include "plot.h"
+#include <qwt_symbol.h>
 #include <qmath.h>
 
 static double randomValue()
@@ -14,8 +15,14 @@ MainWindow::MainWindow()
     d_plot->setTitle( "Scatter Plot" );
     setCentralWidget( d_plot );
 
+    // on raster devices the cached symbols are blended
+    // into the backing store without the paint engine
+    QwtSymbol *symbol = new QwtSymbol( QwtSymbol::Ellipse,
+        QBrush( QColor( "Purple" ) ), QPen( Qt::NoPen ), QSize( 4, 4 ) );
+    d_plot->setSymbol( symbol );
+
     // a million points
-    setSamples( 100000 );
+    setSamples( 1000000 );
 }
 
 void MainWindow::setSamples( int numPoints )
@@ -80,6 +80,10 @@ void Plot::setSymbol( QwtSymbol *symbol )
     {
         d_curve->setStyle( QwtPlotCurve::Dots );
     }
+    else
+    {
+        d_curve->setStyle( QwtPlotCurve::NoCurve );
+    }
 }
 
 void Plot::setSamples( const QVector<QPointF> &samples )
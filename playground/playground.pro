@@ -21,7 +21,9 @@ contains(QWT_CONFIG, QwtPlot) {
         rescaler \
         shapes \
         curvetracker \
-        symbols
+        symbols \
+        pyramidbench \
+        transformbench
 
     contains(QWT_CONFIG, QwtSvg) {
 
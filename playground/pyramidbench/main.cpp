@@ -0,0 +1,156 @@
+#include <qapplication.h>
+#include <qimage.h>
+#include <qpainter.h>
+#include <qelapsedtimer.h>
+#include <qstringlist.h>
+#include <qwt_plot_curve.h>
+#include <qwt_point_data.h>
+#include <qwt_scale_map.h>
+#include <qwt_scale_div.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+  Replot benchmark for QwtPointPyramidData
+
+  A curve is rendered into an image of the size of a typical canvas
+  for series of 1M, 10M and 100M samples - once backed by
+  QwtPointArrayData and once by QwtPointPyramidData. Each series is
+  displayed completely, and then panned through with a zoomed
+  view showing 10% of the samples - what a replot
+  has to do, when navigating in a plot.
+
+  Usage: pyramidbench [ number of samples in millions ... ]
+ */
+
+static const int qwtCanvasWidth = 1600;
+static const int qwtCanvasHeight = 800;
+static const int qwtPanSteps = 20;
+
+static void initSamples( size_t numSamples,
+    QVector<double> &x, QVector<double> &y )
+{
+    x.resize( numSamples );
+    y.resize( numSamples );
+
+    double value = 0.0;
+    for ( size_t i = 0; i < numSamples; i++ )
+    {
+        // a random walk with some noise
+        value += ( qrand() / double( RAND_MAX ) ) - 0.5;
+
+        x[i] = i;
+        y[i] = value + 10.0 * ::sin( i * 1e-4 );
+    }
+}
+
+static double replot( QwtPlotCurve &curve, QImage &image,
+    double x1, double x2, const QwtInterval &yInterval )
+{
+    const QRectF canvasRect = image.rect();
+
+    QwtScaleMap xMap;
+    xMap.setScaleInterval( x1, x2 );
+    xMap.setPaintInterval( canvasRect.left(), canvasRect.right() );
+
+    QwtScaleMap yMap;
+    yMap.setScaleInterval( yInterval.minValue(), yInterval.maxValue() );
+    yMap.setPaintInterval( canvasRect.bottom(), canvasRect.top() );
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // what QwtPlot::replot() does for the curve
+    curve.updateScaleDiv( QwtScaleDiv( x1, x2 ),
+        QwtScaleDiv( yInterval.minValue(), yInterval.maxValue() ) );
+
+    image.fill( Qt::white );
+
+    QPainter painter( &image );
+    curve.draw( &painter, xMap, yMap, canvasRect );
+    painter.end();
+
+    return timer.nsecsElapsed() / 1e6;
+}
+
+static void runBenchmark( const char *name, QwtPlotCurve &curve,
+    size_t numSamples )
+{
+    QImage image( qwtCanvasWidth, qwtCanvasHeight,
+        QImage::Format_ARGB32_Premultiplied );
+
+    const QRectF br = curve.boundingRect();
+    const QwtInterval yInterval( br.top(), br.bottom() );
+
+    const double fullMs = replot( curve, image,
+        br.left(), br.right(), yInterval );
+
+    const double width = 0.1 * br.width();
+    const double step = ( br.width() - width ) / ( qwtPanSteps - 1 );
+
+    double panMs = 0.0;
+    for ( int i = 0; i < qwtPanSteps; i++ )
+    {
+        const double x1 = br.left() + i * step;
+        panMs += replot( curve, image, x1, x1 + width, yInterval );
+    }
+
+    printf( "%10lu  %-8s  %12.2f  %12.2f\n",
+        static_cast<unsigned long>( numSamples ), name,
+        fullMs, panMs / qwtPanSteps );
+}
+
+int main( int argc, char **argv )
+{
+    QApplication app( argc, argv );
+
+    QList<double> millions;
+
+    const QStringList args = app.arguments();
+    for ( int i = 1; i < args.size(); i++ )
+        millions += args[i].toDouble();
+
+    if ( millions.isEmpty() )
+        millions << 1 << 10 << 100;
+
+    printf( "%10s  %-8s  %12s  %12s\n",
+        "samples", "data", "full [ms]", "pan [ms]" );
+
+    for ( int i = 0; i < millions.size(); i++ )
+    {
+        const size_t numSamples = size_t( millions[i] * 1e6 );
+
+        QVector<double> x;
+        QVector<double> y;
+        initSamples( numSamples, x, y );
+
+        {
+            QwtPlotCurve curve;
+            curve.setPaintAttribute( QwtPlotCurve::FilterPointsAggressive );
+            curve.setData( new QwtPointArrayData( x, y ) );
+
+            runBenchmark( "array", curve, numSamples );
+        }
+
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            QwtPointPyramidData *data = new QwtPointPyramidData( x, y );
+            data->setResolution( qwtCanvasWidth );
+
+            const double buildMs = timer.nsecsElapsed() / 1e6;
+
+            QwtPlotCurve curve;
+            curve.setPaintAttribute( QwtPlotCurve::FilterPointsAggressive );
+            curve.setData( data );
+
+            runBenchmark( "pyramid", curve, numSamples );
+
+            printf( "%10s  %-8s  %12.2f\n", "", "build", buildMs );
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <qelapsedtimer.h>
+#include <qvector.h>
+#include <qmath.h>
+#include <qwt_scale_map.h>
+#include <qwt_transform.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+  Micro benchmark for QwtScaleMap
+
+  Maps an array of points with each type of transformation - once
+  point by point with QwtScaleMap::transform( double ) and once
+  with the array version, that uses QwtTransform::transformValues()
+  and the vectorized linear mapping. The result is in
+  million points per second.
+
+  Usage: transformbench [ number of points in millions ]
+ */
+
+static const int qwtRuns = 10;
+
+// a transformation, that has to fall back to transform() for arrays
+class SquareRootTransform: public QwtTransform
+{
+public:
+    virtual double transform( double value ) const
+    {
+        return qSqrt( value );
+    }
+
+    virtual double invTransform( double value ) const
+    {
+        return value * value;
+    }
+
+    virtual QwtTransform *copy() const
+    {
+        return new SquareRootTransform();
+    }
+};
+
+static QwtScaleMap scaleMap( QwtTransform *transform )
+{
+    QwtScaleMap map;
+    map.setTransformation( transform );
+    map.setScaleInterval( 1.0, 1000.0 );
+    map.setPaintInterval( 0.0, 1600.0 );
+
+    return map;
+}
+
+static double pointsPerSecond( qint64 nsecs, int numPoints )
+{
+    return qwtRuns * double( numPoints ) / ( nsecs * 1e-9 ) / 1e6;
+}
+
+static void runBenchmark( const char *name, QwtTransform *transform,
+    const QVector<QPointF> &points )
+{
+    const QwtScaleMap xMap = scaleMap( NULL );
+    const QwtScaleMap yMap = scaleMap( transform );
+
+    const int numPoints = points.size();
+    const QPointF *in = points.constData();
+
+    QVector<QPointF> buffer( numPoints );
+    QPointF *out = buffer.data();
+
+    QElapsedTimer timer;
+
+    timer.start();
+    for ( int run = 0; run < qwtRuns; run++ )
+    {
+        for ( int i = 0; i < numPoints; i++ )
+            out[i] = QwtScaleMap::transform( xMap, yMap, in[i] );
+    }
+    const qint64 singleNSecs = timer.nsecsElapsed();
+
+    timer.start();
+    for ( int run = 0; run < qwtRuns; run++ )
+        QwtScaleMap::transform( xMap, yMap, in, out, numPoints );
+    const qint64 arrayNSecs = timer.nsecsElapsed();
+
+    printf( "%-12s  %14.1f  %14.1f\n", name,
+        pointsPerSecond( singleNSecs, numPoints ),
+        pointsPerSecond( arrayNSecs, numPoints ) );
+}
+
+int main( int argc, char **argv )
+{
+    double millions = 10.0;
+    if ( argc > 1 )
+        millions = ::atof( argv[1] );
+
+    const int numPoints = qMax( int( millions * 1e6 ), 1 );
+
+    QVector<QPointF> points( numPoints );
+    for ( int i = 0; i < numPoints; i++ )
+    {
+        points[i].rx() = 1.0 + ( 999.0 * i ) / numPoints;
+        points[i].ry() = 1.0 + 999.0 * ( qrand() / double( RAND_MAX ) );
+    }
+
+    printf( "%-12s  %14s  %14s\n", "transform",
+        "single [Mp/s]", "array [Mp/s]" );
+
+    runBenchmark( "linear", NULL, points );
+    runBenchmark( "null", new QwtNullTransform(), points );
+    runBenchmark( "log", new QwtLogTransform(), points );
+    runBenchmark( "power", new QwtPowerTransform( 2.0 ), points );
+    runBenchmark( "sqrt", new SquareRootTransform(), points );
+
+    return 0;
+}
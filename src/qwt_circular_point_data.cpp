@@ -0,0 +1,378 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_circular_point_data.h"
+#include <qatomic.h>
+#include <qvector.h>
+#include <qnumeric.h>
+#include <string.h>
+
+/*
+  The counters are positions in an endless stream of samples,
+  that wrap around at 2^32. As the size of the buffer is a power
+  of 2, ( counter & mask ) is the position in the buffer and
+  differences between counters are valid even after wrapping around.
+ */
+
+static inline uint qwtLoadAcquire( QAtomicInt &value )
+{
+#if QT_VERSION >= 0x050000
+    return static_cast<uint>( value.loadAcquire() );
+#else
+    return static_cast<uint>( value.fetchAndAddAcquire( 0 ) );
+#endif
+}
+
+static inline void qwtStoreRelease( QAtomicInt &value, uint v )
+{
+#if QT_VERSION >= 0x050000
+    value.storeRelease( static_cast<int>( v ) );
+#else
+    value.fetchAndStoreRelease( static_cast<int>( v ) );
+#endif
+}
+
+/*
+  Monotonic queue of the candidates for the minimum or maximum
+  of a sliding window. Each sample is inserted and removed once,
+  what results in constant amortized costs per sample.
+ */
+class QwtWindowExtremum
+{
+public:
+    QwtWindowExtremum( bool isMinimum = true ):
+        d_isMinimum( isMinimum ),
+        d_mask( 0 ),
+        d_begin( 0 ),
+        d_end( 0 )
+    {
+    }
+
+    void init( uint bufferSize )
+    {
+        d_entries.resize( bufferSize );
+        d_mask = bufferSize - 1;
+        d_begin = d_end = 0;
+    }
+
+    inline void push( uint pos, double value )
+    {
+        if ( qIsNaN( value ) )
+            return;
+
+        while ( d_end != d_begin )
+        {
+            const double last = d_entries[ ( d_end - 1 ) & d_mask ].value;
+            if ( d_isMinimum ? ( last < value ) : ( last > value ) )
+                break;
+
+            d_end--;
+        }
+
+        Entry &entry = d_entries[ d_end++ & d_mask ];
+        entry.pos = pos;
+        entry.value = value;
+    }
+
+    inline void expire( uint first )
+    {
+        while ( d_begin != d_end &&
+            static_cast<int>( d_entries[ d_begin & d_mask ].pos - first ) < 0 )
+        {
+            d_begin++;
+        }
+    }
+
+    inline bool isEmpty() const
+    {
+        return d_begin == d_end;
+    }
+
+    inline double value() const
+    {
+        return d_entries[ d_begin & d_mask ].value;
+    }
+
+private:
+    struct Entry
+    {
+        uint pos;
+        double value;
+    };
+
+    bool d_isMinimum;
+
+    QVector<Entry> d_entries;
+    uint d_mask;
+    uint d_begin;
+    uint d_end;
+};
+
+class QwtCircularPointData::PrivateData
+{
+public:
+    PrivateData():
+        minX( true ),
+        maxX( false ),
+        minY( true ),
+        maxY( false )
+    {
+    }
+
+    int capacity;
+    uint mask;
+
+    // allocated once and never resized, so that it never detaches
+    QVector<QPointF> buffer;
+    QPointF *samples;
+
+    // number of published samples, written by the producer only
+    QAtomicInt published;
+
+    // owned by the producer
+    uint producerPos;
+
+    // owned by the consumer
+    uint syncedPos;
+    uint clearedPos;
+    uint first;
+    uint size;
+
+    QwtWindowExtremum minX;
+    QwtWindowExtremum maxX;
+    QwtWindowExtremum minY;
+    QwtWindowExtremum maxY;
+};
+
+/*!
+  \brief Constructor
+
+  \param capacity Maximum number of samples, that are displayed.
+                  The oldest samples are dropped, when more samples
+                  have been appended.
+ */
+QwtCircularPointData::QwtCircularPointData( int capacity )
+{
+    d_data = new PrivateData();
+
+    capacity = qMax( capacity, 1 );
+
+    // at least 50% headroom for samples appended while painting
+    uint bufferSize = 1;
+    while ( bufferSize < static_cast<uint>( capacity + capacity / 2 + 1 ) )
+        bufferSize *= 2;
+
+    d_data->capacity = capacity;
+    d_data->mask = bufferSize - 1;
+
+    d_data->buffer.resize( bufferSize );
+    d_data->samples = d_data->buffer.data();
+
+    d_data->producerPos = 0;
+    d_data->syncedPos = 0;
+    d_data->clearedPos = 0;
+    d_data->first = 0;
+    d_data->size = 0;
+
+    d_data->minX.init( bufferSize );
+    d_data->maxX.init( bufferSize );
+    d_data->minY.init( bufferSize );
+    d_data->maxY.init( bufferSize );
+}
+
+//! Destructor
+QwtCircularPointData::~QwtCircularPointData()
+{
+    delete d_data;
+}
+
+//! \return Maximum number of samples, that are displayed
+int QwtCircularPointData::capacity() const
+{
+    return d_data->capacity;
+}
+
+/*!
+  \return Number of samples, that can be appended while the samples
+          of the last snapshot are painted
+ */
+int QwtCircularPointData::headroom() const
+{
+    return static_cast<int>( d_data->mask + 1 ) - d_data->capacity;
+}
+
+/*!
+  Append a sample
+
+  \param sample Sample
+  \note Must be called from the producer thread only
+  \sa synchronize()
+ */
+void QwtCircularPointData::append( const QPointF &sample )
+{
+    const uint pos = d_data->producerPos;
+    d_data->samples[ pos & d_data->mask ] = sample;
+
+    d_data->producerPos = pos + 1;
+    qwtStoreRelease( d_data->published, d_data->producerPos );
+}
+
+/*!
+  Append samples and publish them at once
+
+  \param samples Array of samples
+  \param numSamples Number of samples
+  \note Must be called from the producer thread only
+  \sa synchronize()
+ */
+void QwtCircularPointData::append( const QPointF *samples, int numSamples )
+{
+    if ( numSamples <= 0 )
+        return;
+
+    const uint bufferSize = d_data->mask + 1;
+    if ( static_cast<uint>( numSamples ) > bufferSize )
+    {
+        // only the last samples would survive
+        d_data->producerPos += numSamples - bufferSize;
+        samples += numSamples - bufferSize;
+        numSamples = bufferSize;
+    }
+
+    const uint pos = d_data->producerPos & d_data->mask;
+    const uint n1 = qMin( static_cast<uint>( numSamples ), bufferSize - pos );
+
+    ::memcpy( d_data->samples + pos, samples, n1 * sizeof( QPointF ) );
+    ::memcpy( d_data->samples, samples + n1,
+        ( numSamples - n1 ) * sizeof( QPointF ) );
+
+    d_data->producerPos += numSamples;
+    qwtStoreRelease( d_data->published, d_data->producerPos );
+}
+
+/*!
+  \brief Take a snapshot of the published samples
+
+  Updates size(), sample() and boundingRect() to the most recent
+  samples, that have been appended by the producer.
+
+  \return Number of samples, that have been appended since the
+          last snapshot. The new samples are at the end of the
+          snapshot: [ size() - numNew, size() - 1 ]
+
+  \note Must be called from the consumer ( GUI ) thread only
+ */
+int QwtCircularPointData::synchronize()
+{
+    PrivateData *d = d_data;
+
+    const uint pos = qwtLoadAcquire( d->published );
+
+    const uint size = qMin( pos - d->clearedPos,
+        static_cast<uint>( d->capacity ) );
+    const uint first = pos - size;
+
+    uint from = d->syncedPos;
+    if ( static_cast<int>( first - from ) > 0 )
+        from = first;
+
+    d->minX.expire( first );
+    d->maxX.expire( first );
+    d->minY.expire( first );
+    d->maxY.expire( first );
+
+    for ( uint i = from; i != pos; i++ )
+    {
+        const QPointF &sample = d->samples[ i & d->mask ];
+
+        d->minX.push( i, sample.x() );
+        d->maxX.push( i, sample.x() );
+        d->minY.push( i, sample.y() );
+        d->maxY.push( i, sample.y() );
+    }
+
+    if ( pos != d->syncedPos || first != d->first || size != d->size )
+        incrementRevision();
+
+    d->syncedPos = pos;
+    d->first = first;
+    d->size = size;
+
+    return static_cast<int>( pos - from );
+}
+
+/*!
+  Remove all samples from the snapshot
+
+  Samples, that are appended later, will be part of the
+  next snapshot.
+
+  \note Must be called from the consumer ( GUI ) thread only
+ */
+void QwtCircularPointData::clear()
+{
+    d_data->clearedPos = qwtLoadAcquire( d_data->published );
+    synchronize();
+}
+
+/*!
+  \return Bounding rectangle of the samples of the snapshot
+  \note NaN values are ignored
+ */
+QRectF QwtCircularPointData::boundingRect() const
+{
+    const PrivateData *d = d_data;
+
+    if ( d->minX.isEmpty() || d->minY.isEmpty() )
+        return QRectF( 1.0, 1.0, -2.0, -2.0 ); // invalid
+
+    const double minX = d->minX.value();
+    const double minY = d->minY.value();
+
+    return QRectF( minX, minY,
+        d->maxX.value() - minX, d->maxY.value() - minY );
+}
+
+//! \return Number of samples of the snapshot
+size_t QwtCircularPointData::size() const
+{
+    return d_data->size;
+}
+
+/*!
+  Return the sample at position i
+
+  \param index Index, where 0 is the oldest sample of the snapshot
+  \return Sample at position i
+*/
+QPointF QwtCircularPointData::sample( size_t index ) const
+{
+    const uint pos = d_data->first + static_cast<uint>( index );
+    return d_data->samples[ pos & d_data->mask ];
+}
+
+/*!
+  Copy a range of samples into a buffer
+
+  \param from Index of the first sample
+  \param numSamples Number of samples to copy
+  \param samples Buffer for at least numSamples samples
+*/
+void QwtCircularPointData::copySamples(
+    size_t from, size_t numSamples, QPointF *samples ) const
+{
+    const uint bufferSize = d_data->mask + 1;
+    const uint pos = ( d_data->first + static_cast<uint>( from ) ) & d_data->mask;
+
+    const size_t n1 = qMin( numSamples, static_cast<size_t>( bufferSize - pos ) );
+
+    ::memcpy( samples, d_data->samples + pos, n1 * sizeof( QPointF ) );
+    ::memcpy( samples + n1, d_data->samples,
+        ( numSamples - n1 ) * sizeof( QPointF ) );
+}
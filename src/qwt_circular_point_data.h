@@ -0,0 +1,95 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_CIRCULAR_POINT_DATA_H
+#define QWT_CIRCULAR_POINT_DATA_H 1
+
+#include "qwt_global.h"
+#include "qwt_series_data.h"
+
+/*!
+  \brief Point data in a ring buffer, that is filled by another thread
+
+  QwtCircularPointData stores the most recent capacity() samples, that
+  have been appended by an acquisition thread ( f.e. a QwtSamplingThread ).
+  The producer thread and the GUI thread are synchronized without any
+  locks: append() copies samples into the buffer and publishes them
+  with an atomic counter, synchronize() takes a snapshot of the
+  published samples. So the acquisition never blocks painting and
+  painting never blocks the acquisition.
+
+  All other methods are intended to be called from the GUI thread only.
+  size(), sample() and boundingRect() refer to the snapshot of the last
+  call of synchronize(). The bounding rectangle is maintained for the
+  sliding window of samples with constant costs for each sample.
+
+  The buffer has some headroom beyond capacity(), so that the producer
+  can append samples while the samples of the snapshot are painted.
+  When it appends more than headroom() samples until painting is
+  finished, the oldest samples of the snapshot might be overwritten.
+
+  \par Example
+  \code
+#include <qwt_circular_point_data.h>
+#include <qwt_plot_directpainter.h>
+
+// the sampling thread
+data->append( QPointF( elapsed, value ) );
+
+// the GUI thread, f.e. in a timer event
+const int numNew = data->synchronize();
+if ( numNew > 0 )
+{
+    const int to = data->size() - 1;
+    const int from = qMax( to - numNew, 0 ); // connected to the last point
+
+    directPainter->drawSeries( curve, from, to );
+}
+  \endcode
+
+  As the revision changes with each synchronize(), a curve with
+  QwtPlotCurve::DetectOrder would check the order of all samples for
+  each replot. When the x values are increasing ( f.e. time stamps )
+  the order should be declared by QwtPlotCurve::IncreasingX instead.
+
+  \note There must not be more than one thread calling append()
+  \sa QwtSamplingThread, QwtPlotDirectPainter
+*/
+class QWT_EXPORT QwtCircularPointData: public QwtSeriesData<QPointF>
+{
+public:
+    explicit QwtCircularPointData( int capacity );
+    virtual ~QwtCircularPointData();
+
+    int capacity() const;
+    int headroom() const;
+
+    void append( const QPointF & );
+    void append( const QPointF *, int numSamples );
+
+    int synchronize();
+    void clear();
+
+    virtual QRectF boundingRect() const;
+
+    virtual size_t size() const;
+    virtual QPointF sample( size_t i ) const;
+
+    virtual void copySamples( size_t from,
+        size_t numSamples, QPointF *samples ) const;
+
+private:
+    QwtCircularPointData( const QwtCircularPointData & );
+    QwtCircularPointData &operator=( const QwtCircularPointData & );
+
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
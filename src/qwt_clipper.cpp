@@ -10,8 +10,8 @@
 #include "qwt_clipper.h"
 #include "qwt_point_polar.h"
 #include <qrect.h>
+#include <qnumeric.h>
 #include <string.h>
-#include <stdlib.h>
 
 #if QT_VERSION < 0x040601
 #define qAtan(x) ::atan(x)
@@ -25,7 +25,8 @@ namespace QwtClip
     template <class Point, typename T> class TopEdge;
     template <class Point, typename T> class BottomEdge;
 
-    template <class Point> class PointBuffer;
+    template <class Edge, class Next, class Point> class EdgeStage;
+    template <class Polygon, class Point> class PolygonSink;
 }
 
 template <class Point, typename Value>
@@ -123,85 +124,113 @@ private:
     const Value d_y2;
 };
 
-template<class Point>
-class QwtClip::PointBuffer
+using namespace QwtClip;
+
+/*
+  A stage of the Sutherland-Hodgman pipeline: the points are clipped
+  against one edge and passed to the next stage immediately. So the
+  polygon is clipped in a single pass without temporary buffers.
+ */
+template <class Edge, class Next, class Point>
+class QwtClip::EdgeStage
 {
 public:
-    PointBuffer( int capacity = 0 ):
-        m_capacity( 0 ),
-        m_size( 0 ),
-        m_buffer( NULL )
+    inline EdgeStage( const Edge &edge, Next &next, bool closePolygon ):
+        d_edge( edge ),
+        d_next( next ),
+        d_closePolygon( closePolygon ),
+        d_count( 0 )
     {
-        if ( capacity > 0 )
-            reserve( capacity );
     }
 
-    ~PointBuffer()
+    inline void add( const Point &point )
     {
-        if ( m_buffer )
-            ::free( m_buffer );
+        if ( d_count++ == 0 )
+        {
+            d_first = point;
+
+            if ( !d_closePolygon && d_edge.isInside( point ) )
+                d_next.add( point );
+        }
+        else
+        {
+            clip( d_last, point );
+        }
+
+        d_last = point;
     }
 
-    inline void setPoints( int numPoints, const Point *points )
+    inline void flush()
     {
-        reserve( numPoints );
+        if ( d_count == 1 )
+        {
+            // a single point is passed, even when being outside
+            if ( d_closePolygon || !d_edge.isInside( d_first ) )
+                d_next.add( d_first );
+        }
+        else if ( d_count > 1 && d_closePolygon )
+        {
+            clip( d_last, d_first );
+        }
 
-        m_size = numPoints;
-        ::memcpy( m_buffer, points, m_size * sizeof( Point ) );
+        d_next.flush();
     }
 
-    inline void reset() 
-    { 
-        m_size = 0; 
-    }
+private:
+    inline void clip( const Point &p2, const Point &p1 )
+    {
+        if ( d_edge.isInside( p1 ) )
+        {
+            if ( !d_edge.isInside( p2 ) )
+                d_next.add( d_edge.intersection( p1, p2 ) );
 
-    inline int size() const 
-    { 
-        return m_size; 
+            d_next.add( p1 );
+        }
+        else
+        {
+            if ( d_edge.isInside( p2 ) )
+                d_next.add( d_edge.intersection( p1, p2 ) );
+        }
     }
 
-    inline Point *data() const 
-    { 
-        return m_buffer; 
-    }
+    const Edge d_edge;
+    Next &d_next;
+    const bool d_closePolygon;
 
-    inline Point &operator[]( int i ) 
-    { 
-        return m_buffer[i]; 
-    }
+    int d_count;
+    Point d_first;
+    Point d_last;
+};
 
-    inline const Point &operator[]( int i ) const 
-    { 
-        return m_buffer[i]; 
+template <class Polygon, class Point>
+class QwtClip::PolygonSink
+{
+public:
+    inline PolygonSink( Polygon &polygon ):
+        d_polygon( polygon )
+    {
     }
 
     inline void add( const Point &point )
     {
-        if ( m_capacity <= m_size )
-            reserve( m_size + 1 );
-
-        m_buffer[m_size++] = point;
+        d_polygon += point;
     }
 
-private:
-    inline void reserve( int size )
+    inline void flush()
     {
-        if ( m_capacity == 0 )
-            m_capacity = 1;
-
-        while ( m_capacity < size )
-            m_capacity *= 2;
-
-        m_buffer = static_cast<Point *>( 
-            ::realloc( m_buffer, m_capacity * sizeof( Point ) ) );
     }
 
-    int m_capacity;
-    int m_size;
-    Point *m_buffer;
+private:
+    Polygon &d_polygon;
 };
 
-using namespace QwtClip;
+// reset the size without giving the allocated memory back
+template <class Vector>
+static inline void qwtResetBuffer( Vector &buffer, int capacity )
+{
+    buffer.reserve( qMax( capacity, buffer.capacity() ) );
+    buffer.resize( 0 );
+}
 
 template <class Polygon, class Rect, class Point, typename T>
 class QwtPolygonClipper
@@ -212,93 +241,134 @@ public:
     {
     }
 
-    Polygon clipPolygon( const Polygon &polygon, bool closePolygon ) const
+    void clipPolygon( const Point *points, int numPoints,
+        bool closePolygon, Polygon &clipped ) const
     {
-#if 0
-        if ( d_clipRect.contains( polygon.boundingRect() ) )
-            return polygon;
-#endif
-
-        PointBuffer<Point> points1;
-        PointBuffer<Point> points2( qMin( 256, polygon.size() ) );
-
-        points1.setPoints( polygon.size(), polygon.data() );
-
-        clipEdge< LeftEdge<Point, T> >( closePolygon, points1, points2 );
-        clipEdge< RightEdge<Point, T> >( closePolygon, points2, points1 );
-        clipEdge< TopEdge<Point, T> >( closePolygon, points1, points2 );
-        clipEdge< BottomEdge<Point, T> >( closePolygon, points2, points1 );
+        typedef PolygonSink<Polygon, Point> Sink;
+        typedef EdgeStage< BottomEdge<Point, T>, Sink, Point > Stage4;
+        typedef EdgeStage< TopEdge<Point, T>, Stage4, Point > Stage3;
+        typedef EdgeStage< RightEdge<Point, T>, Stage3, Point > Stage2;
+        typedef EdgeStage< LeftEdge<Point, T>, Stage2, Point > Stage1;
+
+        qwtResetBuffer( clipped, numPoints );
+
+        const T x1 = d_clipRect.x();
+        const T x2 = d_clipRect.x() + d_clipRect.width();
+        const T y1 = d_clipRect.y();
+        const T y2 = d_clipRect.y() + d_clipRect.height();
+
+        Sink sink( clipped );
+        Stage4 stage4( BottomEdge<Point, T>( x1, x2, y1, y2 ),
+            sink, closePolygon );
+        Stage3 stage3( TopEdge<Point, T>( x1, x2, y1, y2 ),
+            stage4, closePolygon );
+        Stage2 stage2( RightEdge<Point, T>( x1, x2, y1, y2 ),
+            stage3, closePolygon );
+        Stage1 stage1( LeftEdge<Point, T>( x1, x2, y1, y2 ),
+            stage2, closePolygon );
+
+        for ( int i = 0; i < numPoints; i++ )
+            stage1.add( points[i] );
+
+        if ( numPoints > 0 )
+            stage1.flush();
+    }
 
-        Polygon p;
-        p.resize( points1.size() );
-        ::memcpy( p.data(), points1.data(), points1.size() * sizeof( Point ) );
+    Polygon clipPolygon( const Polygon &polygon, bool closePolygon ) const
+    {
+        Polygon clipped;
+        clipPolygon( polygon.constData(), polygon.size(),
+            closePolygon, clipped );
 
-        return p;
+        return clipped;
     }
 
 private:
-    template <class Edge>
-    inline void clipEdge( bool closePolygon,
-        PointBuffer<Point> &points, PointBuffer<Point> &clippedPoints ) const
-    {
-        clippedPoints.reset();
+    const Rect d_clipRect;
+};
 
-        if ( points.size() < 2 )
-        {
-            if ( points.size() == 1 )
-                clippedPoints.add( points[0] );
-            return;
-        }
+/*
+  Liang-Barsky line clipping: p1 and p2 are moved to the
+  intersections with the rectangle. False, when the segment
+  is not visible.
+ */
+static inline bool qwtClipSegment( double xMin, double xMax,
+    double yMin, double yMax, QPointF &p1, QPointF &p2 )
+{
+    const double dx = p2.x() - p1.x();
+    const double dy = p2.y() - p1.y();
+
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { p1.x() - xMin, xMax - p1.x(),
+        p1.y() - yMin, yMax - p1.y() };
 
-        const Edge edge( d_clipRect.x(), d_clipRect.x() + d_clipRect.width(),
-            d_clipRect.y(), d_clipRect.y() + d_clipRect.height() );
+    double t0 = 0.0;
+    double t1 = 1.0;
 
-        int lastPos, start;
-        if ( closePolygon )
+    for ( int i = 0; i < 4; i++ )
+    {
+        if ( p[i] == 0.0 )
         {
-            start = 0;
-            lastPos = points.size() - 1;
+            if ( q[i] < 0.0 )
+                return false;
         }
         else
         {
-            start = 1;
-            lastPos = 0;
-
-            if ( edge.isInside( points[0] ) )
-                clippedPoints.add( points[0] );
-        }
-
-        const uint nPoints = points.size();
-        for ( uint i = start; i < nPoints; i++ )
-        {
-            const Point &p1 = points[i];
-            const Point &p2 = points[lastPos];
-
-            if ( edge.isInside( p1 ) )
+            const double t = q[i] / p[i];
+            if ( p[i] < 0.0 )
             {
-                if ( edge.isInside( p2 ) )
-                {
-                    clippedPoints.add( p1 );
-                }
-                else
-                {
-                    clippedPoints.add( edge.intersection( p1, p2 ) );
-                    clippedPoints.add( p1 );
-                }
+                if ( t > t1 )
+                    return false;
+
+                if ( t > t0 )
+                    t0 = t;
             }
             else
             {
-                if ( edge.isInside( p2 ) )
-                {
-                    clippedPoints.add( edge.intersection( p1, p2 ) );
-                }
+                if ( t < t0 )
+                    return false;
+
+                if ( t < t1 )
+                    t1 = t;
             }
-            lastPos = i;
         }
     }
 
-    const Rect d_clipRect;
-};
+    const QPointF p0 = p1;
+
+    if ( t0 > 0.0 )
+        p1 = QPointF( p0.x() + t0 * dx, p0.y() + t0 * dy );
+
+    if ( t1 < 1.0 )
+        p2 = QPointF( p0.x() + t1 * dx, p0.y() + t1 * dy );
+
+    return true;
+}
+
+// outcode of a point with a NaN coordinate
+static const int qwtInvalidCode = 16;
+
+// Cohen-Sutherland outcode
+static inline int qwtOutCode( double xMin, double xMax,
+    double yMin, double yMax, const QPointF &pos )
+{
+    if ( qIsNaN( pos.x() ) || qIsNaN( pos.y() ) )
+        return qwtInvalidCode;
+
+    int code = 0;
+
+    if ( pos.x() < xMin )
+        code |= 1;
+    else if ( pos.x() > xMax )
+        code |= 2;
+
+    if ( pos.y() < yMin )
+        code |= 4;
+    else if ( pos.y() > yMax )
+        code |= 8;
+
+    return code;
+}
 
 class QwtCircleClipper
 {
@@ -489,6 +559,163 @@ QPolygonF QwtClipper::clipPolygonF(
     return clipper.clipPolygon( polygon, closePolygon );
 }
 
+/*!
+   Sutherland-Hodgman polygon clipping into a buffer
+
+   The points are clipped against all edges in a single pass. As the
+   allocated memory of the buffer is reused, clipping a sequence
+   of polygons into the same buffer avoids allocations.
+
+   \param clipRect Clip rectangle
+   \param points Array of points
+   \param numPoints Number of points
+   \param closePolygon True, when the polygon is closed
+   \param clipped Buffer for the clipped polygon
+*/
+void QwtClipper::clipPolygonF( const QRectF &clipRect,
+    const QPointF *points, int numPoints, bool closePolygon,
+    QPolygonF &clipped )
+{
+    QwtPolygonClipper<QPolygonF, QRectF, QPointF, double> clipper( clipRect );
+    clipper.clipPolygon( points, numPoints, closePolygon, clipped );
+}
+
+/*!
+   \brief Split a polyline into its visible parts
+
+   In opposite to clipPolygonF(), the parts of the polyline outside
+   of the clip rectangle are removed instead of being replaced by
+   lines along its border. The segments are clipped by the
+   Liang-Barsky algorithm, segments between points inside of the
+   rectangle are copied without any calculation. Points with a NaN
+   coordinate are treated as gaps, that split the polyline.
+
+   The visible parts are stored one after the other in clipped,
+   runs contains the index behind the last point of each part.
+   As the allocated memory of the buffers is reused, clipping
+   into the same buffers avoids allocations.
+
+   \param clipRect Clip rectangle
+   \param points Array of points
+   \param numPoints Number of points
+   \param clipped Buffer for the points of the visible parts
+   \param runs Buffer for the end positions of the visible parts
+
+   \return Number of visible parts
+
+   \par Example
+   \code
+QwtClipper::clipPolyline( clipRect, points, numPoints, clipped, runs );
+
+int from = 0;
+for ( int i = 0; i < runs.size(); i++ )
+{
+    QwtPainter::drawPolyline( painter,
+        clipped.constData() + from, runs[i] - from );
+
+    from = runs[i];
+}
+   \endcode
+*/
+int QwtClipper::clipPolyline( const QRectF &clipRect,
+    const QPointF *points, int numPoints,
+    QPolygonF &clipped, QVector<int> &runs )
+{
+    qwtResetBuffer( clipped, numPoints );
+    qwtResetBuffer( runs, 1 );
+
+    if ( numPoints <= 0 )
+        return 0;
+
+    const double xMin = clipRect.left();
+    const double xMax = clipRect.right();
+    const double yMin = clipRect.top();
+    const double yMax = clipRect.bottom();
+
+    int code0 = qwtOutCode( xMin, xMax, yMin, yMax, points[0] );
+
+    if ( numPoints == 1 )
+    {
+        if ( code0 == 0 )
+        {
+            clipped += points[0];
+            runs += 1;
+        }
+
+        return runs.size();
+    }
+
+    bool isOpen = false; // a part is open
+
+    for ( int i = 1; i < numPoints; i++ )
+    {
+        const int code1 = qwtOutCode( xMin, xMax, yMin, yMax, points[i] );
+
+        if ( ( code0 | code1 ) == 0 )
+        {
+            if ( !isOpen )
+            {
+                clipped += points[i - 1];
+                isOpen = true;
+            }
+
+            // copy the following points inside in one go
+            int j = i + 1;
+            while ( j < numPoints &&
+                qwtOutCode( xMin, xMax, yMin, yMax, points[j] ) == 0 )
+            {
+                j++;
+            }
+
+            const int size = clipped.size();
+            clipped.resize( size + j - i );
+            ::memcpy( clipped.data() + size, points + i,
+                ( j - i ) * sizeof( QPointF ) );
+
+            i = j - 1;
+        }
+        else if ( ( code0 | code1 ) & qwtInvalidCode )
+        {
+            // a point with a NaN coordinate breaks the polyline
+            if ( isOpen )
+            {
+                runs += clipped.size();
+                isOpen = false;
+            }
+        }
+        else if ( ( code0 & code1 ) == 0 )
+        {
+            QPointF p1 = points[i - 1];
+            QPointF p2 = points[i];
+
+            if ( qwtClipSegment( xMin, xMax, yMin, yMax, p1, p2 ) )
+            {
+                if ( !isOpen )
+                {
+                    clipped += p1;
+                    isOpen = true;
+                }
+
+                clipped += p2;
+            }
+
+            if ( code1 != 0 && isOpen )
+            {
+                runs += clipped.size();
+                isOpen = false;
+            }
+        }
+
+        // after copying, points[i] is inside as well
+        code0 = code1;
+    }
+
+    if ( isOpen )
+        runs += clipped.size();
+
+    return runs.size();
+}
+
 /*!
    Circle clipping
 
@@ -33,6 +33,14 @@ public:
     static QPolygonF clipPolygonF( const QRectF &, 
         const QPolygonF &, bool closePolygon = false );
 
+    static void clipPolygonF( const QRectF &,
+        const QPointF *points, int numPoints, bool closePolygon,
+        QPolygonF &clipped );
+
+    static int clipPolyline( const QRectF &,
+        const QPointF *points, int numPoints,
+        QPolygonF &clipped, QVector<int> &runs );
+
     static QVector<QwtInterval> clipCircle(
         const QRectF &, const QPointF &, double radius );
 };
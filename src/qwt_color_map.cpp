@@ -10,7 +10,80 @@
 #include "qwt_color_map.h"
 #include "qwt_math.h"
 #include "qwt_interval.h"
+#include "qwt_simd_p.h"
 #include <qnumeric.h>
+#include <string.h>
+#include <typeinfo>
+
+// number of colors of the lookup table of QwtLinearColorMap
+static const int qwtColorTableSize = 4096;
+
+/*
+  Map values into colors of a table with maxIndex + 2 entries,
+  where table[maxIndex + 1] is the color for NaN values.
+
+  index := int( qBound( 0, ( value - min ) * scale, maxIndex ) + 0.5 )
+
+  The SSE2 and the scalar loop both round by truncating, so that
+  a value is mapped to the same color, no matter where it is
+  in the array.
+ */
+static void qwtLookupColors( const double *values, int numValues,
+    double min, double scale, int maxIndex,
+    const QRgb *table, QRgb *rgbs )
+{
+    int i = 0;
+
+#if QWT_USE_SSE2
+    const __m128d vmin = _mm_set1_pd( min );
+    const __m128d vscale = _mm_set1_pd( scale );
+    const __m128d vzero = _mm_setzero_pd();
+    const __m128d vmax = _mm_set1_pd( maxIndex );
+    const __m128d vnan = _mm_set1_pd( maxIndex + 1 );
+    const __m128d vhalf = _mm_set1_pd( 0.5 );
+
+    for ( ; i + 2 <= numValues; i += 2 )
+    {
+        const __m128d v = _mm_loadu_pd( values + i );
+
+        // max/min return the second operand for NaN: 0.0
+        __m128d t = _mm_mul_pd( _mm_sub_pd( v, vmin ), vscale );
+        t = _mm_min_pd( _mm_max_pd( t, vzero ), vmax );
+
+        const __m128d isNaN = _mm_cmpunord_pd( v, v );
+        t = _mm_or_pd( _mm_andnot_pd( isNaN, t ), _mm_and_pd( isNaN, vnan ) );
+
+        const __m128i index = _mm_cvttpd_epi32( _mm_add_pd( t, vhalf ) );
+
+        rgbs[i] = table[ _mm_cvtsi128_si32( index ) ];
+        rgbs[i + 1] = table[ _mm_cvtsi128_si32( _mm_srli_si128( index, 4 ) ) ];
+    }
+#endif
+
+    for ( ; i < numValues; i++ )
+    {
+        const double v = values[i];
+
+        int index;
+        if ( qIsNaN( v ) )
+        {
+            index = maxIndex + 1;
+        }
+        else
+        {
+            const double t = ( v - min ) * scale;
+
+            if ( !( t > 0.0 ) )
+                index = 0;
+            else if ( t >= maxIndex )
+                index = maxIndex;
+            else
+                index = int( t + 0.5 );
+        }
+
+        rgbs[i] = table[index];
+    }
+}
 
 class QwtLinearColorMap::ColorStops
 {
@@ -177,11 +250,65 @@ QVector<QRgb> QwtColorMap::colorTable( const QwtInterval &interval ) const
     return table;
 }
 
+/*!
+   \brief Map an array of values into RGB values
+
+   The default implementation calls rgb() for each value.
+
+   \param interval Range for the values
+   \param values Array of values
+   \param numValues Number of values
+   \param rgbs Buffer for at least numValues RGB values
+
+   \sa rgb(), colorIndexes()
+*/
+void QwtColorMap::rgbValues( const QwtInterval &interval,
+    const double *values, int numValues, QRgb *rgbs ) const
+{
+    for ( int i = 0; i < numValues; i++ )
+        rgbs[i] = rgb( interval, values[i] );
+}
+
+/*!
+   \brief Map an array of values into color indices
+
+   The default implementation calls colorIndex() for each value.
+
+   \param interval Range for the values
+   \param values Array of values
+   \param numValues Number of values
+   \param indexes Buffer for at least numValues indices
+
+   \sa colorIndex(), rgbValues()
+*/
+void QwtColorMap::colorIndexes( const QwtInterval &interval,
+    const double *values, int numValues, unsigned char *indexes ) const
+{
+    for ( int i = 0; i < numValues; i++ )
+        indexes[i] = colorIndex( interval, values[i] );
+}
+
 class QwtLinearColorMap::PrivateData
 {
 public:
+    void updateTable()
+    {
+        // the last entry is for NaN values, see rgb()
+        table.resize( qwtColorTableSize + 1 );
+
+        for ( int i = 0; i < qwtColorTableSize; i++ )
+        {
+            const double pos = double( i ) / ( qwtColorTableSize - 1 );
+            table[i] = colorStops.rgb( mode, pos );
+        }
+
+        table[qwtColorTableSize] = qRgba( 0, 0, 0, 0 );
+    }
+
     ColorStops colorStops;
     QwtLinearColorMap::Mode mode;
+
+    QVector<QRgb> table;
 };
 
 /*!
@@ -233,6 +360,7 @@ QwtLinearColorMap::~QwtLinearColorMap()
 void QwtLinearColorMap::setMode( Mode mode )
 {
     d_data->mode = mode;
+    d_data->updateTable();
 }
 
 /*!
@@ -260,6 +388,8 @@ void QwtLinearColorMap::setColorInterval(
     d_data->colorStops = ColorStops();
     d_data->colorStops.insert( 0.0, color1 );
     d_data->colorStops.insert( 1.0, color2 );
+
+    d_data->updateTable();
 }
 
 /*!
@@ -275,7 +405,10 @@ void QwtLinearColorMap::setColorInterval(
 void QwtLinearColorMap::addColorStop( double value, const QColor& color )
 {
     if ( value >= 0.0 && value <= 1.0 )
+    {
         d_data->colorStops.insert( value, color );
+        d_data->updateTable();
+    }
 }
 
 /*!
@@ -357,11 +490,141 @@ unsigned char QwtLinearColorMap::colorIndex(
     return index;
 }
 
+/*!
+  \brief Map an array of values into RGB values
+
+  In ScaledColors mode the colors are looked up in a table of 4096
+  colors, so that the result might differ slightly from rgb() - by less
+  than 1/4096 of the interval in the position of the color.
+  In FixedColors mode a table would move the boundaries between
+  the color stops, so the colors are calculated like in rgb().
+
+  \note The table is built from the color stops without calling rgb().
+        For derived classes, that might have reimplemented rgb(),
+        QwtColorMap::rgbValues() is called instead, what maps
+        the values one by one.
+
+  \param interval Range for all values
+  \param values Array of values
+  \param numValues Number of values
+  \param rgbs Buffer for at least numValues RGB values
+*/
+void QwtLinearColorMap::rgbValues( const QwtInterval &interval,
+    const double *values, int numValues, QRgb *rgbs ) const
+{
+    if ( typeid( *this ) != typeid( QwtLinearColorMap ) )
+    {
+        QwtColorMap::rgbValues( interval, values, numValues, rgbs );
+        return;
+    }
+
+    const double width = interval.width();
+
+    if ( d_data->mode == FixedColors )
+    {
+        const double min = interval.minValue();
+        const ColorStops &colorStops = d_data->colorStops;
+
+        for ( int i = 0; i < numValues; i++ )
+        {
+            const double v = values[i];
+
+            if ( qIsNaN( v ) )
+            {
+                rgbs[i] = qRgba( 0, 0, 0, 0 );
+            }
+            else
+            {
+                double ratio = 0.0;
+                if ( width > 0.0 )
+                    ratio = ( v - min ) / width;
+
+                rgbs[i] = colorStops.rgb( FixedColors, ratio );
+            }
+        }
+
+        return;
+    }
+
+    double scale = 0.0;
+    if ( width > 0.0 )
+        scale = ( qwtColorTableSize - 1 ) / width;
+
+    qwtLookupColors( values, numValues, interval.minValue(), scale,
+        qwtColorTableSize - 1, d_data->table.constData(), rgbs );
+}
+
+/*!
+  \brief Map an array of values into color indices
+
+  For derived classes, that might have reimplemented colorIndex(),
+  QwtColorMap::colorIndexes() is called instead.
+
+  \param interval Range for all values
+  \param values Array of values
+  \param numValues Number of values
+  \param indexes Buffer for at least numValues indices
+
+  \sa colorIndex()
+*/
+void QwtLinearColorMap::colorIndexes( const QwtInterval &interval,
+    const double *values, int numValues, unsigned char *indexes ) const
+{
+    if ( typeid( *this ) != typeid( QwtLinearColorMap ) )
+    {
+        QwtColorMap::colorIndexes( interval, values, numValues, indexes );
+        return;
+    }
+
+    const double width = interval.width();
+    const double min = interval.minValue();
+    const double max = interval.maxValue();
+
+    if ( width <= 0.0 )
+    {
+        ::memset( indexes, 0, numValues );
+        return;
+    }
+
+    const double scale = 255.0 / width;
+    const bool fixed = ( d_data->mode == FixedColors );
+
+    for ( int i = 0; i < numValues; i++ )
+    {
+        const double v = values[i];
+
+        unsigned char index;
+        if ( qIsNaN( v ) || v <= min )
+            index = 0;
+        else if ( v >= max )
+            index = 255;
+        else if ( fixed )
+            index = static_cast<unsigned char>( ( v - min ) * scale );
+        else
+            index = static_cast<unsigned char>( qRound( ( v - min ) * scale ) );
+
+        indexes[i] = index;
+    }
+}
+
 class QwtAlphaColorMap::PrivateData
 {
 public:
+    void updateTable()
+    {
+        // the last entry is for NaN values, see rgb()
+        table.resize( 257 );
+
+        for ( int alpha = 0; alpha < 256; alpha++ )
+            table[alpha] = rgb | ( uint( alpha ) << 24 );
+
+        table[256] = rgb;
+    }
+
     QColor color;
     QRgb rgb;
+
+    QVector<QRgb> table;
 };
 
 
@@ -375,6 +638,7 @@ QwtAlphaColorMap::QwtAlphaColorMap( const QColor &color ):
     d_data = new PrivateData;
     d_data->color = color;
     d_data->rgb = color.rgb() & qRgba( 255, 255, 255, 0 );
+    d_data->updateTable();
 }
 
 //! Destructor
@@ -393,6 +657,7 @@ void QwtAlphaColorMap::setColor( const QColor &color )
 {
     d_data->color = color;
     d_data->rgb = color.rgb();
+    d_data->updateTable();
 }
 
 /*!
@@ -430,6 +695,33 @@ QRgb QwtAlphaColorMap::rgb( const QwtInterval &interval, double value ) const
     return d_data->rgb;
 }
 
+/*!
+  \brief Map an array of values into RGB values with alpha values
+
+  For derived classes, that might have reimplemented rgb(),
+  QwtColorMap::rgbValues() is called instead.
+
+  \param interval Range for all values
+  \param values Array of values
+  \param numValues Number of values
+  \param rgbs Buffer for at least numValues RGB values
+
+  \sa rgb()
+*/
+void QwtAlphaColorMap::rgbValues( const QwtInterval &interval,
+    const double *values, int numValues, QRgb *rgbs ) const
+{
+    const double width = interval.width();
+    if ( width <= 0.0 || typeid( *this ) != typeid( QwtAlphaColorMap ) )
+    {
+        QwtColorMap::rgbValues( interval, values, numValues, rgbs );
+        return;
+    }
+
+    qwtLookupColors( values, numValues, interval.minValue(),
+        255.0 / width, 255, d_data->table.constData(), rgbs );
+}
+
 /*!
   Dummy function, needed to be implemented as it is pure virtual
   in QwtColorMap. Color indices make no sense in combination with
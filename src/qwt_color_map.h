@@ -75,6 +75,12 @@ public:
     virtual unsigned char colorIndex(
         const QwtInterval &interval, double value ) const = 0;
 
+    virtual void rgbValues( const QwtInterval &,
+        const double *values, int numValues, QRgb *rgbs ) const;
+
+    virtual void colorIndexes( const QwtInterval &,
+        const double *values, int numValues, unsigned char *indexes ) const;
+
     QColor color( const QwtInterval &, double value ) const;
     virtual QVector<QRgb> colorTable( const QwtInterval & ) const;
 
@@ -88,6 +94,12 @@ private:
   A color stop is a color at a specific position. The valid
   range for the positions is [0.0, 1.0]. When mapping a value
   into a color it is translated into this interval according to mode().
+
+  For mapping arrays of values in ScaledColors mode rgbValues() looks
+  up the colors in a table of 4096 colors, that is built, when the
+  color stops or the mode are modified. The table is used for
+  objects of QwtLinearColorMap only and not for derived classes,
+  that might have reimplemented rgb().
 */
 class QWT_EXPORT QwtLinearColorMap: public QwtColorMap
 {
@@ -125,6 +137,12 @@ public:
     virtual unsigned char colorIndex(
         const QwtInterval &, double value ) const;
 
+    virtual void rgbValues( const QwtInterval &,
+        const double *values, int numValues, QRgb *rgbs ) const;
+
+    virtual void colorIndexes( const QwtInterval &,
+        const double *values, int numValues, unsigned char *indexes ) const;
+
     class ColorStops;
 
 private:
@@ -150,6 +168,9 @@ public:
 
     virtual QRgb rgb( const QwtInterval &, double value ) const;
 
+    virtual void rgbValues( const QwtInterval &,
+        const double *values, int numValues, QRgb *rgbs ) const;
+
 private:
     QwtAlphaColorMap( const QwtAlphaColorMap & );
     QwtAlphaColorMap &operator=( const QwtAlphaColorMap & );
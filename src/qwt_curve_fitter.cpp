@@ -12,6 +12,14 @@
 #include "qwt_spline.h"
 #include <qstack.h>
 #include <qvector.h>
+#include <string.h>
+
+#if QT_VERSION >= 0x040400 && !defined(QT_NO_QFUTURE)
+#include <qthread.h>
+#include <qfuture.h>
+#include <qtconcurrentrun.h>
+#define QWT_USE_THREADS 1
+#endif
 
 #if QT_VERSION < 0x040601
 #define qFabs(x) ::fabs(x)
@@ -27,6 +35,22 @@ QwtCurveFitter::~QwtCurveFitter()
 {
 }
 
+/*!
+  A fitter is local, when the fitted curve close to a point depends
+  on its neighbours only and the first and last points of a polygon
+  are part of the fitted curve. Then consecutive parts of a polygon,
+  that share their borders, can be fitted one by one.
+
+  QwtPlotCurve maps, fits and paints the curves of local fitters
+  in batches of points.
+
+  \return false
+ */
+bool QwtCurveFitter::isLocal() const
+{
+    return false;
+}
+
 class QwtSplineCurveFitter::PrivateData
 {
 public:
@@ -242,17 +266,74 @@ QPolygonF QwtSplineCurveFitter::fitParametric( const QPolygonF &points ) const
     return fittedPoints;
 }
 
+// distance of the point, that is most far away from the line
+// between p[from] and p[to]
+static double qwtMaxDistanceSqr( const QPointF *p,
+    int from, int to, int &index )
+{
+    // initialize line segment
+    const double vecX = p[to].x() - p[from].x();
+    const double vecY = p[to].y() - p[from].y();
+
+    const double vecLength = qSqrt( vecX * vecX + vecY * vecY );
+
+    const double unitVecX = ( vecLength != 0.0 ) ? vecX / vecLength : 0.0;
+    const double unitVecY = ( vecLength != 0.0 ) ? vecY / vecLength : 0.0;
+
+    double maxDistSqr = 0.0;
+    index = from + 1;
+
+    for ( int i = from + 1; i < to; i++ )
+    {
+        //compare to anchor
+        const double fromVecX = p[i].x() - p[from].x();
+        const double fromVecY = p[i].y() - p[from].y();
+
+        double distToSegmentSqr;
+        if ( fromVecX * unitVecX + fromVecY * unitVecY < 0.0 )
+        {
+            distToSegmentSqr = fromVecX * fromVecX + fromVecY * fromVecY;
+        }
+        else
+        {
+            const double toVecX = p[i].x() - p[to].x();
+            const double toVecY = p[i].y() - p[to].y();
+            const double toVecLength = toVecX * toVecX + toVecY * toVecY;
+
+            const double s = toVecX * ( -unitVecX ) + toVecY * ( -unitVecY );
+            if ( s < 0.0 )
+            {
+                distToSegmentSqr = toVecLength;
+            }
+            else
+            {
+                distToSegmentSqr = qFabs( toVecLength - s * s );
+            }
+        }
+
+        if ( maxDistSqr < distToSegmentSqr )
+        {
+            maxDistSqr = distToSegmentSqr;
+            index = i;
+        }
+    }
+
+    return maxDistSqr;
+}
+
 class QwtWeedingCurveFitter::PrivateData
 {
 public:
     PrivateData():
         tolerance( 1.0 ),
-        chunkSize( 0 )
+        chunkSize( 0 ),
+        numThreads( 1 )
     {
     }
 
     double tolerance;
     uint chunkSize;
+    uint numThreads;
 };
 
 class QwtWeedingCurveFitter::Line
@@ -343,110 +424,258 @@ uint QwtWeedingCurveFitter::chunkSize() const
     return d_data->chunkSize;
 }
 
+/*!
+  \brief Set the number of threads for fitting a polygon
+
+  The chunks of the polygon ( setChunkSize() ) - or the ranges, that
+  result from the first splits of the polygon - are independent of
+  each other and are processed in parallel. The result is the same
+  as for a single thread.
+
+  \param numThreads Number of threads. 0 means
+                    QThread::idealThreadCount(). The default is 1.
+
+  \note Polygons with less than 10000 points are always fitted
+        by the calling thread.
+  \sa threadCount(), QwtPlotItem::setRenderThreadCount()
+*/
+void QwtWeedingCurveFitter::setThreadCount( uint numThreads )
+{
+    d_data->numThreads = numThreads;
+}
+
+/*!
+  \return Number of threads for fitting a polygon
+  \sa setThreadCount()
+*/
+uint QwtWeedingCurveFitter::threadCount() const
+{
+    return d_data->numThreads;
+}
+
+/*!
+  The fitted curve consists of points of the original polygon
+  including its first and last point.
+
+  \return true
+  \sa QwtCurveFitter::isLocal()
+*/
+bool QwtWeedingCurveFitter::isLocal() const
+{
+    return true;
+}
+
 /*!
   \param points Series of data points
   \return Curve points
 */
 QPolygonF QwtWeedingCurveFitter::fitCurve( const QPolygonF &points ) const
 {
-    QPolygonF fittedPoints;
+    const int numPoints = points.size();
+
+    uint numThreads = d_data->numThreads;
+
+#if QWT_USE_THREADS
+    if ( numThreads == 0 )
+        numThreads = QThread::idealThreadCount();
 
-    if ( d_data->chunkSize == 0 )
+    // for small polygons the overhead of the threads doesn't pay off
+    const int minChunkSize = 10000;
+    numThreads = qMin( numThreads,
+        uint( qMax( numPoints / minChunkSize, 1 ) ) );
+#else
+    numThreads = 1;
+#endif
+
+    if ( d_data->chunkSize == 0 && numThreads <= 1 )
+        return simplify( points );
+
+    if ( numPoints <= 2 )
+        return points;
+
+    /*
+      Chunks are disjoint, while the ranges of a split share
+      the point, where the polygon has been split.
+     */
+    const bool isSplit = ( d_data->chunkSize == 0 );
+
+    QVector<Line> ranges;
+    if ( isSplit )
     {
-        fittedPoints = simplify( points );
+        ranges = splitRanges( points.constData(), numPoints, 4 * numThreads );
     }
     else
     {
-        for ( int i = 0; i < points.size(); i += d_data->chunkSize )
+        const int chunkSize = d_data->chunkSize;
+        for ( int i = 0; i < numPoints; i += chunkSize )
+            ranges += Line( i, qMin( i + chunkSize, numPoints ) - 1 );
+    }
+
+    const int numRanges = ranges.size();
+    numThreads = qMin( numThreads, uint( numRanges ) );
+
+    // the ranges are compacted in place
+    QPolygonF fittedPoints = points;
+    QPointF *p = fittedPoints.data();
+
+#if QWT_USE_THREADS
+    QList< QFuture<void> > futures;
+    for ( uint i = 1; i < numThreads; i++ )
+    {
+        futures += QtConcurrent::run(
+            this, &QwtWeedingCurveFitter::simplifyRanges,
+            p, ranges.data(), numRanges, int( i ), int( numThreads ) );
+    }
+#endif
+
+    simplifyRanges( p, ranges.data(), numRanges, 0, numThreads );
+
+#if QWT_USE_THREADS
+    for ( int i = 0; i < futures.size(); i++ )
+        futures[i].waitForFinished();
+#endif
+
+    // now Line::to is the end of the points, that have been kept
+
+    int size = 0;
+    for ( int i = 0; i < numRanges; i++ )
+    {
+        int from = ranges[i].from;
+        if ( isSplit && i > 0 )
+            from++; // the last point of the previous range
+
+        const int count = ranges[i].to - from;
+        if ( from != size )
         {
-            const QPolygonF p = points.mid( i, d_data->chunkSize );
-            fittedPoints += simplify( p );
+            ::memmove( p + size, p + from, count * sizeof( QPointF ) );
         }
+
+        size += count;
     }
 
+    fittedPoints.resize( size );
     return fittedPoints;
 }
 
-QPolygonF QwtWeedingCurveFitter::simplify( const QPolygonF &points ) const
+/*
+  Split the polygon like the algorithm does, until there are
+  enough ranges, that can be processed independently
+ */
+QVector<QwtWeedingCurveFitter::Line> QwtWeedingCurveFitter::splitRanges(
+    const QPointF *p, int size, int count ) const
 {
     const double toleranceSqr = d_data->tolerance * d_data->tolerance;
 
-    QStack<Line> stack;
-    stack.reserve( 500 );
-
-    const QPointF *p = points.data();
-    const int nPoints = points.size();
-
-    QVector<bool> usePoint( nPoints, false );
+    // splitting small ranges doesn't improve the load balancing
+    const int minRangeSize = 1000;
 
-    stack.push( Line( 0, nPoints - 1 ) );
+    QVector<Line> ranges;
+    ranges += Line( 0, size - 1 );
 
-    while ( !stack.isEmpty() )
+    bool hasSplit = true;
+    while ( hasSplit && ranges.size() < count )
     {
-        const Line r = stack.pop();
-
-        // initialize line segment
-        const double vecX = p[r.to].x() - p[r.from].x();
-        const double vecY = p[r.to].y() - p[r.from].y();
-
-        const double vecLength = qSqrt( vecX * vecX + vecY * vecY );
+        hasSplit = false;
 
-        const double unitVecX = ( vecLength != 0.0 ) ? vecX / vecLength : 0.0;
-        const double unitVecY = ( vecLength != 0.0 ) ? vecY / vecLength : 0.0;
+        QVector<Line> splitted;
+        splitted.reserve( 2 * ranges.size() );
 
-        double maxDistSqr = 0.0;
-        int nVertexIndexMaxDistance = r.from + 1;
-        for ( int i = r.from + 1; i < r.to; i++ )
+        for ( int i = 0; i < ranges.size(); i++ )
         {
-            //compare to anchor
-            const double fromVecX = p[i].x() - p[r.from].x();
-            const double fromVecY = p[i].y() - p[r.from].y();
+            const Line &r = ranges[i];
 
-            double distToSegmentSqr;
-            if ( fromVecX * unitVecX + fromVecY * unitVecY < 0.0 )
+            if ( r.to - r.from >= minRangeSize )
             {
-                distToSegmentSqr = fromVecX * fromVecX + fromVecY * fromVecY;
-            }
-            else
-            {
-                const double toVecX = p[i].x() - p[r.to].x();
-                const double toVecY = p[i].y() - p[r.to].y();
-                const double toVecLength = toVecX * toVecX + toVecY * toVecY;
+                int index;
+                const double maxDistSqr =
+                    qwtMaxDistanceSqr( p, r.from, r.to, index );
 
-                const double s = toVecX * ( -unitVecX ) + toVecY * ( -unitVecY );
-                if ( s < 0.0 )
+                if ( maxDistSqr > toleranceSqr )
                 {
-                    distToSegmentSqr = toVecLength;
-                }
-                else
-                {
-                    distToSegmentSqr = qFabs( toVecLength - s * s );
+                    splitted += Line( r.from, index );
+                    splitted += Line( index, r.to );
+
+                    hasSplit = true;
+                    continue;
                 }
             }
 
-            if ( maxDistSqr < distToSegmentSqr )
-            {
-                maxDistSqr = distToSegmentSqr;
-                nVertexIndexMaxDistance = i;
-            }
+            splitted += r;
         }
-        if ( maxDistSqr <= toleranceSqr )
+
+        ranges = splitted;
+    }
+
+    return ranges;
+}
+
+/*
+  Simplify every step'th range beginning with first and
+  replace Line::to by the end of the points, that have been kept
+ */
+void QwtWeedingCurveFitter::simplifyRanges( QPointF *p,
+    Line *ranges, int numRanges, int first, int step ) const
+{
+    for ( int i = first; i < numRanges; i += step )
+        ranges[i].to = simplifyRange( p, ranges[i].from, ranges[i].to );
+}
+
+/*
+  Douglas and Peucker algorithm for p[from] - p[to].
+
+  The left part of a split is processed first, so that the points,
+  that are kept, are found in increasing order. They are moved
+  to the front of the range immediately without overwriting
+  any point, that is still needed. p[from] is always kept and
+  p[to] is never overwritten.
+
+  Returns the end of the points, that have been kept.
+ */
+int QwtWeedingCurveFitter::simplifyRange( QPointF *p, int from, int to ) const
+{
+    const double toleranceSqr = d_data->tolerance * d_data->tolerance;
+
+    int pos = from + 1;
+    if ( to <= from )
+        return pos;
+
+    QStack<Line> stack;
+    stack.reserve( 500 );
+
+    stack.push( Line( from, to ) );
+
+    while ( !stack.isEmpty() )
+    {
+        const Line r = stack.pop();
+
+        int index;
+        if ( qwtMaxDistanceSqr( p, r.from, r.to, index ) <= toleranceSqr )
         {
-            usePoint[r.from] = true;
-            usePoint[r.to] = true;
+            if ( pos != r.to )
+                p[pos] = p[r.to];
+
+            pos++;
         }
         else
         {
-            stack.push( Line( r.from, nVertexIndexMaxDistance ) );
-            stack.push( Line( nVertexIndexMaxDistance, r.to ) );
+            stack.push( Line( index, r.to ) );
+            stack.push( Line( r.from, index ) );
         }
     }
 
-    QPolygonF stripped;
-    for ( int i = 0; i < nPoints; i++ )
+    return pos;
+}
+
+QPolygonF QwtWeedingCurveFitter::simplify( const QPolygonF &points ) const
+{
+    QPolygonF stripped = points;
+
+    if ( !stripped.isEmpty() )
     {
-        if ( usePoint[i] )
-            stripped += p[i];
+        const int size = simplifyRange(
+            stripped.data(), 0, stripped.size() - 1 );
+
+        stripped.resize( size );
     }
 
     return stripped;
@@ -32,6 +32,8 @@ public:
      */
     virtual QPolygonF fitCurve( const QPolygonF &polygon ) const = 0;
 
+    virtual bool isLocal() const;
+
 protected:
     QwtCurveFitter();
 
@@ -112,6 +114,17 @@ private:
   the number of points. By adjusting the tolerance parameter according to the
   axis scales QwtSplineCurveFitter can be used to implement different
   level of details to speed up painting of curves of many points.
+
+  QwtPlotCurve fits the points after they have been mapped to the
+  paint device, so that the tolerance is in pixels and doesn't need
+  to be adjusted, when the scales change. As the algorithm is local
+  ( isLocal() ), the curve is fitted in the same batches, that are
+  mapped and painted one after the other. So the fitter can be enabled
+  for curves of any size.
+
+  The parts, that are independent of each other - the chunks or the
+  ranges, that result from the first splits of the polygon - can be
+  processed in parallel ( setThreadCount() ).
 */
 class QWT_EXPORT QwtWeedingCurveFitter: public QwtCurveFitter
 {
@@ -125,13 +138,24 @@ public:
     void setChunkSize( uint );
     uint chunkSize() const;
 
+    void setThreadCount( uint );
+    uint threadCount() const;
+
     virtual QPolygonF fitCurve( const QPolygonF & ) const;
+    virtual bool isLocal() const;
 
 private:
     virtual QPolygonF simplify( const QPolygonF & ) const;
 
     class Line;
 
+    QVector<Line> splitRanges( const QPointF *, int size, int count ) const;
+
+    void simplifyRanges( QPointF *,
+        Line *ranges, int numRanges, int first, int step ) const;
+
+    int simplifyRange( QPointF *, int from, int to ) const;
+
     class PrivateData;
     PrivateData *d_data;
 };
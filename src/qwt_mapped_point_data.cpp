@@ -0,0 +1,572 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_mapped_point_data.h"
+#include <qfile.h>
+#include <qnumeric.h>
+#include <string.h>
+#include <limits.h>
+
+template <typename T>
+static inline double qwtMappedValue( const uchar *p )
+{
+    // the position in the file doesn't need to be aligned
+    T value;
+    ::memcpy( &value, p, sizeof( T ) );
+
+    return static_cast<double>( value );
+}
+
+// values are written to every 2nd double: the x or y members of QPointF
+template <typename T>
+static void qwtCopyValues( const uchar *p, size_t stride,
+    size_t numValues, double factor, double offset, double *values )
+{
+    for ( size_t i = 0; i < numValues; i++ )
+    {
+        values[2 * i] = qwtMappedValue<T>( p ) * factor + offset;
+        p += stride;
+    }
+}
+
+template <typename T>
+static void qwtMappedMinMax( const uchar *p, size_t stride,
+    size_t numValues, double &min, double &max )
+{
+    double lo = qInf();
+    double hi = -qInf();
+
+    for ( size_t i = 0; i < numValues; i++ )
+    {
+        const double v = qwtMappedValue<T>( p );
+
+        // NaN values fail both comparisons
+        if ( v < lo )
+            lo = v;
+
+        if ( v > hi )
+            hi = v;
+
+        p += stride;
+    }
+
+    min = lo;
+    max = hi;
+}
+
+class QwtMappedPointData::PrivateData
+{
+public:
+    PrivateData():
+        data( NULL ),
+        dataSize( 0 ),
+        valueType( QwtMappedPointData::Float64 ),
+        layout( QwtMappedPointData::Interleaved ),
+        factor( 1.0 ),
+        offset( 0.0 ),
+        implicitX( false ),
+        x0( 0.0 ),
+        dx( 1.0 ),
+        valueCount( 0 ),
+        size( 0 )
+    {
+    }
+
+    size_t valueSize() const
+    {
+        switch( valueType )
+        {
+            case QwtMappedPointData::Int16:
+                return 2;
+            case QwtMappedPointData::Float32:
+                return 4;
+            default:
+                return 8;
+        }
+    }
+
+    void copyValues( const uchar *p, size_t stride, size_t numValues,
+        double factor, double offset, double *values ) const
+    {
+        switch( valueType )
+        {
+            case QwtMappedPointData::Int16:
+                qwtCopyValues<qint16>( p, stride,
+                    numValues, factor, offset, values );
+                break;
+            case QwtMappedPointData::Float32:
+                qwtCopyValues<float>( p, stride,
+                    numValues, factor, offset, values );
+                break;
+            default:
+                qwtCopyValues<double>( p, stride,
+                    numValues, factor, offset, values );
+        }
+    }
+
+    // copy points as pairs of doubles: x1, y1, x2, y2 ...
+    void copyPoints( size_t from, size_t numPoints, double *values ) const
+    {
+        size_t stride;
+
+        if ( implicitX )
+        {
+            for ( size_t i = 0; i < numPoints; i++ )
+                values[2 * i] = x0 + ( from + i ) * dx;
+        }
+        else
+        {
+            const uchar *x = xValue( from, stride );
+            copyValues( x, stride, numPoints, 1.0, 0.0, values );
+        }
+
+        const uchar *y = yValue( from, stride );
+        copyValues( y, stride, numPoints, factor, offset, values + 1 );
+    }
+
+    bool minMax( const uchar *p, size_t stride,
+        double factor, double offset, double &min, double &max ) const
+    {
+        switch( valueType )
+        {
+            case QwtMappedPointData::Int16:
+                qwtMappedMinMax<qint16>( p, stride, size, min, max );
+                break;
+            case QwtMappedPointData::Float32:
+                qwtMappedMinMax<float>( p, stride, size, min, max );
+                break;
+            default:
+                qwtMappedMinMax<double>( p, stride, size, min, max );
+        }
+
+        if ( min > max )
+            return false;
+
+        min = min * factor + offset;
+        max = max * factor + offset;
+
+        if ( min > max )
+            qSwap( min, max );
+
+        return true;
+    }
+
+    // position and distance of x/y values of sample index in bytes
+    const uchar *xValue( size_t index, size_t &stride ) const
+    {
+        const size_t sz = valueSize();
+
+        if ( layout == QwtMappedPointData::Interleaved )
+        {
+            stride = 2 * sz;
+            return data + index * stride;
+        }
+
+        stride = sz;
+        return data + index * sz;
+    }
+
+    const uchar *yValue( size_t index, size_t &stride ) const
+    {
+        const size_t sz = valueSize();
+
+        if ( implicitX )
+        {
+            stride = sz;
+            return data + index * sz;
+        }
+
+        if ( layout == QwtMappedPointData::Interleaved )
+        {
+            stride = 2 * sz;
+            return data + index * stride + sz;
+        }
+
+        stride = sz;
+        return data + ( valueCount + index ) * sz;
+    }
+
+    QFile file;
+
+    const uchar *data;
+    qint64 dataSize;
+
+    QwtMappedPointData::ValueType valueType;
+    QwtMappedPointData::Layout layout;
+
+    double factor;
+    double offset;
+
+    bool implicitX;
+    double x0;
+    double dx;
+
+    // number of x or y values in the memory block
+    size_t valueCount;
+
+    // number of samples, limited to the int indices of the curves
+    size_t size;
+};
+
+/*!
+  \brief Constructor
+
+  The initial format are interleaved 64 bit floating point numbers
+  with explicit x values. No data is assigned.
+
+  \sa open(), setRawData()
+ */
+QwtMappedPointData::QwtMappedPointData()
+{
+    d_data = new PrivateData();
+}
+
+//! Destructor, unmaps the file
+QwtMappedPointData::~QwtMappedPointData()
+{
+    close();
+    delete d_data;
+}
+
+/*!
+  \brief Map a file into memory
+
+  The file is mapped from offset to its end. All pages are read
+  on demand by the operating system, when the samples are accessed.
+
+  \param fileName Name of the file
+  \param offset Position of the first value in the file, f.e.
+                to skip a header
+
+  \return true, when the file could be mapped
+  \sa close(), setRawData(), isOpen()
+ */
+bool QwtMappedPointData::open( const QString &fileName, qint64 offset )
+{
+    close();
+
+    QFile &file = d_data->file;
+
+    file.setFileName( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) )
+        return false;
+
+    const qint64 size = file.size() - offset;
+    if ( offset < 0 || size <= 0 )
+    {
+        file.close();
+        return false;
+    }
+
+    const uchar *data = file.map( offset, size );
+    if ( data == NULL )
+    {
+        file.close();
+        return false;
+    }
+
+    d_data->data = data;
+    d_data->dataSize = size;
+
+    update();
+
+    return true;
+}
+
+/*!
+  \brief Assign a block of memory
+
+  This can be a block of shared memory or a file, that has been
+  mapped by the application.
+
+  \param data Pointer to the first value
+  \param size Size of the block in bytes
+
+  \warning The programmer must assure that the memory block remains
+           valid during the lifetime of the object or until close()
+           is called.
+  \sa open(), close()
+ */
+void QwtMappedPointData::setRawData( const void *data, qint64 size )
+{
+    close();
+
+    if ( data && size > 0 )
+    {
+        d_data->data = static_cast<const uchar *>( data );
+        d_data->dataSize = size;
+    }
+
+    update();
+}
+
+/*!
+  Unmap a file, that has been opened by open(),
+  or detach from a block of memory.
+
+  \sa open(), setRawData()
+ */
+void QwtMappedPointData::close()
+{
+    QFile &file = d_data->file;
+
+    if ( file.isOpen() )
+    {
+        if ( d_data->data )
+            file.unmap( const_cast<uchar *>( d_data->data ) );
+
+        file.close();
+    }
+
+    d_data->data = NULL;
+    d_data->dataSize = 0;
+
+    update();
+}
+
+//! \return true, when a file or block of memory is assigned
+bool QwtMappedPointData::isOpen() const
+{
+    return d_data->data != NULL;
+}
+
+/*!
+  Set the format of the stored values
+
+  \param valueType Type of the values
+  \param layout Arrangement of the x and y values. It is
+                irrelevant for implicit x values.
+
+  \sa valueType(), layout()
+ */
+void QwtMappedPointData::setFormat( ValueType valueType, Layout layout )
+{
+    d_data->valueType = valueType;
+    d_data->layout = layout;
+
+    update();
+}
+
+//! \return Type of the stored values
+QwtMappedPointData::ValueType QwtMappedPointData::valueType() const
+{
+    return d_data->valueType;
+}
+
+//! \return Arrangement of the x and y values
+QwtMappedPointData::Layout QwtMappedPointData::layout() const
+{
+    return d_data->layout;
+}
+
+/*!
+  Set a linear transformation for the y values
+
+  y = value * factor + offset
+
+  \param factor Factor
+  \param offset Offset
+
+  \sa scaleFactor(), scaleOffset()
+ */
+void QwtMappedPointData::setScale( double factor, double offset )
+{
+    d_data->factor = factor;
+    d_data->offset = offset;
+
+    d_boundingRect = QRectF( 0.0, 0.0, -1.0, -1.0 );
+    incrementRevision();
+}
+
+//! \return Factor of the linear transformation of the y values
+double QwtMappedPointData::scaleFactor() const
+{
+    return d_data->factor;
+}
+
+//! \return Offset of the linear transformation of the y values
+double QwtMappedPointData::scaleOffset() const
+{
+    return d_data->offset;
+}
+
+/*!
+  \brief Calculate the x values instead of reading them
+
+  For equidistant samples the memory contains the y values only
+  and x = x0 + i * dx.
+
+  \param x0 x value of the first sample
+  \param dx Distance between 2 samples
+
+  \sa setExplicitX(), hasImplicitX()
+ */
+void QwtMappedPointData::setImplicitX( double x0, double dx )
+{
+    d_data->implicitX = true;
+    d_data->x0 = x0;
+    d_data->dx = dx;
+
+    update();
+}
+
+/*!
+  Read the x values from memory
+
+  \sa setImplicitX(), hasImplicitX()
+ */
+void QwtMappedPointData::setExplicitX()
+{
+    d_data->implicitX = false;
+    update();
+}
+
+//! \return true, when the x values are calculated
+bool QwtMappedPointData::hasImplicitX() const
+{
+    return d_data->implicitX;
+}
+
+//! \return x value of the first sample for implicit x values
+double QwtMappedPointData::x0() const
+{
+    return d_data->x0;
+}
+
+//! \return Distance between 2 samples for implicit x values
+double QwtMappedPointData::dx() const
+{
+    return d_data->dx;
+}
+
+/*!
+  \brief Calculate the bounding rectangle
+
+  For explicit x values and for the y values the bounding rectangle
+  is calculated once by iterating over all samples and is stored for
+  all following requests.
+
+  \return Bounding rectangle
+  \note NaN values are ignored
+*/
+QRectF QwtMappedPointData::boundingRect() const
+{
+    if ( d_boundingRect.width() >= 0.0 )
+        return d_boundingRect;
+
+    if ( d_data->size == 0 )
+        return QRectF( 1.0, 1.0, -2.0, -2.0 ); // invalid
+
+    double minX, maxX, minY, maxY;
+
+    size_t stride;
+
+    if ( d_data->implicitX )
+    {
+        minX = d_data->x0;
+        maxX = d_data->x0 + ( d_data->size - 1 ) * d_data->dx;
+
+        if ( minX > maxX )
+            qSwap( minX, maxX );
+    }
+    else
+    {
+        const uchar *x = d_data->xValue( 0, stride );
+        if ( !d_data->minMax( x, stride, 1.0, 0.0, minX, maxX ) )
+            return QRectF( 1.0, 1.0, -2.0, -2.0 );
+    }
+
+    const uchar *y = d_data->yValue( 0, stride );
+    if ( !d_data->minMax( y, stride,
+        d_data->factor, d_data->offset, minY, maxY ) )
+    {
+        return QRectF( 1.0, 1.0, -2.0, -2.0 );
+    }
+
+    d_boundingRect = QRectF( minX, minY, maxX - minX, maxY - minY );
+    return d_boundingRect;
+}
+
+/*!
+  \return Number of complete samples in the memory block
+
+  \note As the plot items index samples by int, the number is
+        limited to INT_MAX. Samples behind are ignored.
+ */
+size_t QwtMappedPointData::size() const
+{
+    return d_data->size;
+}
+
+/*!
+  Return the sample at position i
+
+  \param index Index
+  \return Sample at position i
+*/
+QPointF QwtMappedPointData::sample( size_t index ) const
+{
+    QPointF point;
+    copySamples( index, 1, &point );
+
+    return point;
+}
+
+/*!
+  Copy a range of samples into a buffer
+
+  \param from Index of the first sample
+  \param numSamples Number of samples to copy
+  \param samples Buffer for at least numSamples samples
+*/
+void QwtMappedPointData::copySamples(
+    size_t from, size_t numSamples, QPointF *samples ) const
+{
+    if ( sizeof( QPointF ) == 2 * sizeof( double ) )
+    {
+        // QPointF is a pair of doubles
+        d_data->copyPoints( from, numSamples,
+            reinterpret_cast<double *>( samples ) );
+
+        return;
+    }
+
+    const size_t chunkSize = 256;
+    double values[2 * chunkSize];
+
+    for ( size_t i = 0; i < numSamples; i += chunkSize )
+    {
+        const size_t n = qMin( chunkSize, numSamples - i );
+        d_data->copyPoints( from + i, n, values );
+
+        QPointF *p = samples + i;
+        for ( size_t j = 0; j < n; j++ )
+        {
+            p[j].rx() = values[2 * j];
+            p[j].ry() = values[2 * j + 1];
+        }
+    }
+}
+
+/*!
+  Recalculate the number of samples after the data or the format
+  have been changed and invalidate the bounding rectangle.
+ */
+void QwtMappedPointData::update()
+{
+    size_t numValues = d_data->dataSize / d_data->valueSize();
+    if ( !d_data->implicitX )
+        numValues /= 2;
+
+    d_data->valueCount = numValues;
+    d_data->size = qMin( numValues, size_t( INT_MAX ) );
+    d_boundingRect = QRectF( 0.0, 0.0, -1.0, -1.0 );
+
+    incrementRevision();
+}
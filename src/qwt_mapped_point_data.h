@@ -0,0 +1,122 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_MAPPED_POINT_DATA_H
+#define QWT_MAPPED_POINT_DATA_H 1
+
+#include "qwt_global.h"
+#include "qwt_series_data.h"
+
+class QString;
+
+/*!
+  \brief Point data, that is read from a memory mapped file or
+         a block of shared memory
+
+  QwtMappedPointData interprets a block of memory as samples without
+  copying them. Opening a file of several GB is instant and the samples
+  don't occupy any heap memory, as the operating system pages in the
+  parts of the file, that are accessed.
+
+  The values might be stored as 16 bit integers or as floating point
+  numbers, that are translated by a linear factor and offset.
+  The x and y values are either interleaved ( x0, y0, x1, y1, ... ) or
+  the block of y values follows the block of x values. For equidistant
+  samples the x values can be calculated from x = x0 + i * dx, so that
+  the memory contains the y values only.
+
+  The values are expected in the byte order of the host.
+
+  \par Example
+  \verbatim
+#include <qwt_mapped_point_data.h>
+#include <qwt_plot_curve.h>
+
+QwtMappedPointData *data = new QwtMappedPointData();
+data->setFormat( QwtMappedPointData::Int16, QwtMappedPointData::Planar );
+data->setScale( 10.0 / 32768, 0.0 ); // +/- 10V
+data->setImplicitX( 0.0, 1.0 / 48000 ); // 48kHz
+
+if ( data->open( "capture.raw" ) )
+    curve->setData( data );
+\endverbatim
+
+  \note The bounding rectangle has to be calculated by iterating
+        over all values, when the curve is autoscaled.
+  \sa QwtCPointerData, QwtPointPyramidData
+*/
+class QWT_EXPORT QwtMappedPointData: public QwtSeriesData<QPointF>
+{
+public:
+    //! Type of the stored values
+    enum ValueType
+    {
+        //! 16 bit signed integer
+        Int16,
+
+        //! 32 bit floating point number
+        Float32,
+
+        //! 64 bit floating point number
+        Float64
+    };
+
+    //! Arrangement of the x and y values
+    enum Layout
+    {
+        //! x and y values alternate
+        Interleaved,
+
+        //! All x values followed by all y values
+        Planar
+    };
+
+    QwtMappedPointData();
+    virtual ~QwtMappedPointData();
+
+    bool open( const QString &fileName, qint64 offset = 0 );
+    void setRawData( const void *data, qint64 size );
+    void close();
+
+    bool isOpen() const;
+
+    void setFormat( ValueType, Layout = Interleaved );
+    ValueType valueType() const;
+    Layout layout() const;
+
+    void setScale( double factor, double offset );
+    double scaleFactor() const;
+    double scaleOffset() const;
+
+    void setImplicitX( double x0, double dx );
+    void setExplicitX();
+
+    bool hasImplicitX() const;
+    double x0() const;
+    double dx() const;
+
+    virtual QRectF boundingRect() const;
+
+    virtual size_t size() const;
+    virtual QPointF sample( size_t i ) const;
+
+    virtual void copySamples( size_t from,
+        size_t numSamples, QPointF *samples ) const;
+
+private:
+    QwtMappedPointData( const QwtMappedPointData & );
+    QwtMappedPointData &operator=( const QwtMappedPointData & );
+
+    void update();
+
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
@@ -10,31 +10,320 @@
 #include "qwt_matrix_raster_data.h"
 #include <qnumeric.h>
 #include <qmath.h>
+#include <qalgorithms.h>
+#include <qvector.h>
+
+/*
+  Matrix indices for coordinates, where -1 indicates
+  a coordinate outside of the interval
+ */
+static void qwtNearestIndexes( const QwtInterval &interval,
+    double step, int count, const double *values, int numValues,
+    QVector<int> &indexes )
+{
+    indexes.resize( numValues );
+    int *idx = indexes.data();
+
+    for ( int i = 0; i < numValues; i++ )
+    {
+        if ( interval.contains( values[i] ) )
+        {
+            // see QwtMatrixRasterData::value()
+            idx[i] = qMin( int( ( values[i] - interval.minValue() ) / step ),
+                count - 1 );
+        }
+        else
+        {
+            idx[i] = -1;
+        }
+    }
+}
+
+/*
+  Pairs of matrix indices and the weight of the first index
+  for bilinear interpolation. -1 indicates a coordinate
+  outside of the interval.
+ */
+static void qwtBilinearIndexes( const QwtInterval &interval,
+    double step, int count, const double *values, int numValues,
+    QVector<int> &indexes, QVector<double> &weights )
+{
+    indexes.resize( 2 * numValues );
+    weights.resize( numValues );
+
+    int *idx = indexes.data();
+    double *w = weights.data();
+
+    for ( int i = 0; i < numValues; i++ )
+    {
+        const double v = values[i];
+
+        if ( !interval.contains( v ) )
+        {
+            idx[2 * i] = idx[2 * i + 1] = -1;
+            w[i] = 0.0;
+
+            continue;
+        }
+
+        // see QwtMatrixRasterData::value()
+        int i1 = qRound( ( v - interval.minValue() ) / step ) - 1;
+        int i2 = i1 + 1;
+
+        if ( i1 < 0 )
+            i1 = i2;
+        else if ( i2 >= count )
+            i2 = i1;
+
+        const double v2 = interval.minValue() + ( i2 + 0.5 ) * step;
+
+        idx[2 * i] = i1;
+        idx[2 * i + 1] = i2;
+        w[i] = ( v2 - v ) / step;
+    }
+}
+
+/*
+  Lookup tables for the columns and rows of a raster, that have been
+  calculated by initRasterCoordinates(). Each raster has its own
+  tables, that are read only while its tiles are resampled.
+ */
+class QwtMatrixRasterTables: public QwtRasterData::RasterCoordinates
+{
+public:
+    QwtMatrixRasterTables( const double *x, int numX,
+            const double *y, int numY ):
+        QwtRasterData::RasterCoordinates( x, numX, y, numY ),
+        resampleMode( QwtMatrixRasterData::NearestNeighbour ),
+        numColumns( 0 ),
+        numRows( 0 )
+    {
+    }
+
+    // the layout of the matrix, the tables have been calculated for
+    QwtMatrixRasterData::ResampleMode resampleMode;
+    QwtInterval xInterval;
+    QwtInterval yInterval;
+    int numColumns;
+    int numRows;
+
+    QVector<int> cols;
+    QVector<double> rx;
+
+    QVector<int> rows;
+    QVector<double> ry;
+};
+
+template <typename T>
+static inline double qwtMatrixValue( const uchar *line, int col )
+{
+    return static_cast<double>( reinterpret_cast<const T *>( line )[col] );
+}
+
+template <typename T>
+static void qwtResampleNearest( const uchar *matrix, int bytesPerLine,
+    const int *rows, int numY, const int *cols, int numX,
+    double factor, double offset, double *values )
+{
+    for ( int r = 0; r < numY; r++ )
+    {
+        double *line = values + r * numX;
+
+        if ( rows[r] < 0 )
+        {
+            qFill( line, line + numX, qQNaN() );
+            continue;
+        }
+
+        const T *row = reinterpret_cast<const T *>(
+            matrix + rows[r] * bytesPerLine );
+
+        for ( int c = 0; c < numX; c++ )
+        {
+            const int col = cols[c];
+            line[c] = ( col >= 0 ) ? row[col] * factor + offset : qQNaN();
+        }
+    }
+}
+
+template <typename T>
+static void qwtResampleBilinear( const uchar *matrix, int bytesPerLine,
+    const int *rows, const double *ry, int numY,
+    const int *cols, const double *rx, int numX,
+    double factor, double offset, double *values )
+{
+    for ( int r = 0; r < numY; r++ )
+    {
+        double *line = values + r * numX;
+
+        if ( rows[2 * r] < 0 )
+        {
+            qFill( line, line + numX, qQNaN() );
+            continue;
+        }
+
+        const T *row1 = reinterpret_cast<const T *>(
+            matrix + rows[2 * r] * bytesPerLine );
+        const T *row2 = reinterpret_cast<const T *>(
+            matrix + rows[2 * r + 1] * bytesPerLine );
+        const double wy = ry[r];
+
+        for ( int c = 0; c < numX; c++ )
+        {
+            const int col1 = cols[2 * c];
+            if ( col1 < 0 )
+            {
+                line[c] = qQNaN();
+                continue;
+            }
+
+            const int col2 = cols[2 * c + 1];
+            const double wx = rx[c];
+
+            const double vr1 = wx * row1[col1] + ( 1.0 - wx ) * row1[col2];
+            const double vr2 = wx * row2[col1] + ( 1.0 - wx ) * row2[col2];
+
+            line[c] = ( wy * vr1 + ( 1.0 - wy ) * vr2 ) * factor + offset;
+        }
+    }
+}
 
 class QwtMatrixRasterData::PrivateData
 {
 public:
     PrivateData():
         resampleMode(QwtMatrixRasterData::NearestNeighbour),
-        numColumns(0)
+        rawValues( NULL ),
+        valueType( QwtMatrixRasterData::Float64 ),
+        bytesPerLine( 0 ),
+        factor( 1.0 ),
+        offset( 0.0 ),
+        numColumns(0),
+        rawRows( 0 )
     {
     }
 
+    inline const uchar *matrix() const
+    {
+        if ( rawValues )
+            return rawValues;
+
+        return reinterpret_cast<const uchar *>( values.constData() );
+    }
+
     inline double value(int row, int col) const
     {
-        return values.data()[ row * numColumns + col ];
+        const uchar *line = matrix() + row * bytesPerLine;
+
+        double v;
+        switch( valueType )
+        {
+            case QwtMatrixRasterData::UInt8:
+                v = qwtMatrixValue<quint8>( line, col );
+                break;
+            case QwtMatrixRasterData::UInt16:
+                v = qwtMatrixValue<quint16>( line, col );
+                break;
+            case QwtMatrixRasterData::Int32:
+                v = qwtMatrixValue<qint32>( line, col );
+                break;
+            case QwtMatrixRasterData::Float32:
+                v = qwtMatrixValue<float>( line, col );
+                break;
+            default:
+                v = qwtMatrixValue<double>( line, col );
+        }
+
+        return v * factor + offset;
     }
 
+    void resample( const int *rows, const double *ry, int numY,
+        const int *cols, const double *rx, int numX, double *values ) const;
+
     QwtMatrixRasterData::ResampleMode resampleMode;
 
     QVector<double> values;
+
+    // matrix owned by the application
+    const uchar *rawValues;
+
+    QwtMatrixRasterData::ValueType valueType;
+    int bytesPerLine;
+
+    double factor;
+    double offset;
+
     int numColumns;
     int numRows;
+    int rawRows;
 
     double dx;
     double dy;
 };
 
+/*
+  Resample the matrix from the indices of the rows and columns. The
+  weights ry/rx are used for BilinearInterpolation only, where
+  rows/cols are pairs of indices.
+ */
+void QwtMatrixRasterData::PrivateData::resample(
+    const int *rows, const double *ry, int numY,
+    const int *cols, const double *rx, int numX, double *values ) const
+{
+    const uchar *m = matrix();
+
+    if ( resampleMode == QwtMatrixRasterData::BilinearInterpolation )
+    {
+        switch( valueType )
+        {
+            case QwtMatrixRasterData::UInt8:
+                qwtResampleBilinear<quint8>( m, bytesPerLine,
+                    rows, ry, numY, cols, rx, numX, factor, offset, values );
+                break;
+            case QwtMatrixRasterData::UInt16:
+                qwtResampleBilinear<quint16>( m, bytesPerLine,
+                    rows, ry, numY, cols, rx, numX, factor, offset, values );
+                break;
+            case QwtMatrixRasterData::Int32:
+                qwtResampleBilinear<qint32>( m, bytesPerLine,
+                    rows, ry, numY, cols, rx, numX, factor, offset, values );
+                break;
+            case QwtMatrixRasterData::Float32:
+                qwtResampleBilinear<float>( m, bytesPerLine,
+                    rows, ry, numY, cols, rx, numX, factor, offset, values );
+                break;
+            default:
+                qwtResampleBilinear<double>( m, bytesPerLine,
+                    rows, ry, numY, cols, rx, numX, factor, offset, values );
+        }
+    }
+    else
+    {
+        switch( valueType )
+        {
+            case QwtMatrixRasterData::UInt8:
+                qwtResampleNearest<quint8>( m, bytesPerLine,
+                    rows, numY, cols, numX, factor, offset, values );
+                break;
+            case QwtMatrixRasterData::UInt16:
+                qwtResampleNearest<quint16>( m, bytesPerLine,
+                    rows, numY, cols, numX, factor, offset, values );
+                break;
+            case QwtMatrixRasterData::Int32:
+                qwtResampleNearest<qint32>( m, bytesPerLine,
+                    rows, numY, cols, numX, factor, offset, values );
+                break;
+            case QwtMatrixRasterData::Float32:
+                qwtResampleNearest<float>( m, bytesPerLine,
+                    rows, numY, cols, numX, factor, offset, values );
+                break;
+            default:
+                qwtResampleNearest<double>( m, bytesPerLine,
+                    rows, numY, cols, numX, factor, offset, values );
+        }
+    }
+}
+
 //! Constructor
 QwtMatrixRasterData::QwtMatrixRasterData()
 {
@@ -57,6 +346,7 @@ QwtMatrixRasterData::~QwtMatrixRasterData()
 void QwtMatrixRasterData::setResampleMode( ResampleMode mode )
 {
     d_data->resampleMode = mode;
+    incrementRevision();
 }
 
 /*!
@@ -109,16 +399,139 @@ void QwtMatrixRasterData::setValueMatrix(
 {
     d_data->values = values;
     d_data->numColumns = qMax( numColumns, 0 );
+
+    d_data->rawValues = NULL;
+    d_data->rawRows = 0;
+    d_data->valueType = Float64;
+    d_data->bytesPerLine = d_data->numColumns * sizeof( double );
+
     update();
 }
 
 /*!
    \return Value matrix
+
+   \note For a raw matrix the values are converted into a vector
+         of doubles ( including the value scale ), what is expensive
+         for large matrices.
+
    \sa setValueMatrix(), numColumns(), numRows(), setInterval()
 */
 const QVector<double> QwtMatrixRasterData::valueMatrix() const
 {
-    return d_data->values;
+    if ( d_data->rawValues == NULL )
+        return d_data->values;
+
+    QVector<double> values( d_data->numRows * d_data->numColumns );
+
+    double *v = values.data();
+    for ( int row = 0; row < d_data->numRows; row++ )
+    {
+        for ( int col = 0; col < d_data->numColumns; col++ )
+            *v++ = d_data->value( row, col );
+    }
+
+    return values;
+}
+
+/*!
+   \brief Assign a matrix, that is owned by the application
+
+   The values are read from memory, whenever they are needed,
+   without copying or converting them. The application might modify
+   the values between 2 replots, but needs to call
+   QwtPlotRasterItem::invalidateCache() or incrementRevision() afterwards.
+
+   \param values Pointer to the first value of the first row
+   \param valueType Type of the values
+   \param numColumns Number of columns
+   \param numRows Number of rows
+   \param bytesPerLine Distance between the first values of 2 rows in bytes.
+                       0 means, that the rows are stored without any padding.
+
+   \warning The programmer must assure that the memory block remains
+           valid during the lifetime of the object or until another
+           matrix is assigned.
+
+   \sa setValueMatrix(), hasRawMatrix(), setValueScale()
+*/
+void QwtMatrixRasterData::setRawMatrix( const void *values,
+    ValueType valueType, int numColumns, int numRows, int bytesPerLine )
+{
+    static const int valueSizes[] = { 1, 2, 4, 4, 8 };
+
+    d_data->values.clear();
+
+    if ( values == NULL || numColumns <= 0 || numRows <= 0 )
+    {
+        d_data->rawValues = NULL;
+        d_data->numColumns = 0;
+        d_data->rawRows = 0;
+        d_data->valueType = Float64;
+        d_data->bytesPerLine = 0;
+    }
+    else
+    {
+        const int minBytesPerLine = numColumns * valueSizes[valueType];
+
+        d_data->rawValues = static_cast<const uchar *>( values );
+        d_data->numColumns = numColumns;
+        d_data->rawRows = numRows;
+        d_data->valueType = valueType;
+        d_data->bytesPerLine = qMax( bytesPerLine, minBytesPerLine );
+    }
+
+    update();
+}
+
+/*!
+   \return true, when the matrix is owned by the application
+   \sa setRawMatrix(), setValueMatrix()
+*/
+bool QwtMatrixRasterData::hasRawMatrix() const
+{
+    return d_data->rawValues != NULL;
+}
+
+/*!
+   \return Type of the values in the matrix
+   \sa setRawMatrix()
+*/
+QwtMatrixRasterData::ValueType QwtMatrixRasterData::valueType() const
+{
+    return d_data->valueType;
+}
+
+/*!
+   Set a linear transformation for the values of the matrix
+
+   value = matrixValue * factor + offset
+
+   f.e. to convert the counts of a detector into physical units.
+
+   \param factor Factor
+   \param offset Offset
+
+   \sa valueScaleFactor(), valueScaleOffset(), setRawMatrix()
+*/
+void QwtMatrixRasterData::setValueScale( double factor, double offset )
+{
+    d_data->factor = factor;
+    d_data->offset = offset;
+
+    incrementRevision();
+}
+
+//! \return Factor of the linear transformation of the values
+double QwtMatrixRasterData::valueScaleFactor() const
+{
+    return d_data->factor;
+}
+
+//! \return Offset of the linear transformation of the values
+double QwtMatrixRasterData::valueScaleOffset() const
+{
+    return d_data->offset;
 }
 
 /*!
@@ -128,15 +541,22 @@ const QVector<double> QwtMatrixRasterData::valueMatrix() const
   \param col Column index
   \param value New value
 
+  \note Values of a raw matrix can't be changed
+
   \sa value(), setValueMatrix()
 */
 void QwtMatrixRasterData::setValue( int row, int col, double value )
 {
+    if ( d_data->rawValues )
+        return;
+
     if ( row >= 0 && row < d_data->numRows &&
         col >= 0 && col < d_data->numColumns )
     {
         const int index = row * d_data->numColumns + col;
         d_data->values.data()[ index ] = value;
+
+        incrementRevision();
     }
 }
 
@@ -197,6 +617,59 @@ QRectF QwtMatrixRasterData::pixelHint( const QRectF &area ) const
     return rect;
 }
 
+/*!
+   \brief Precompute the lookup tables for a raster
+
+   The matrix indices and interpolation weights for the columns and rows
+   are calculated once, so that rasterValues() doesn't need to do it for
+   each row of an image.
+
+   \param x Array of the x coordinates of the columns
+   \param numX Number of columns
+   \param y Array of the y coordinates of the rows
+   \param numY Number of rows
+
+   \return Lookup tables of the raster, to be deleted by the caller
+
+   \note rasterValues() expects the objects returned from this
+         implementation. A derived class, that reimplements
+         initRasterCoordinates(), has to reimplement rasterValues() too.
+
+   \sa rasterValues(), values()
+*/
+QwtRasterData::RasterCoordinates *QwtMatrixRasterData::initRasterCoordinates(
+    const double *x, int numX, const double *y, int numY ) const
+{
+    QwtMatrixRasterTables *tables =
+        new QwtMatrixRasterTables( x, numX, y, numY );
+
+    tables->resampleMode = d_data->resampleMode;
+    tables->xInterval = interval( Qt::XAxis );
+    tables->yInterval = interval( Qt::YAxis );
+    tables->numColumns = d_data->numColumns;
+    tables->numRows = d_data->numRows;
+
+    if ( numX <= 0 || numY <= 0 )
+        return tables;
+
+    if ( d_data->resampleMode == BilinearInterpolation )
+    {
+        qwtBilinearIndexes( tables->xInterval, d_data->dx,
+            d_data->numColumns, x, numX, tables->cols, tables->rx );
+        qwtBilinearIndexes( tables->yInterval, d_data->dy,
+            d_data->numRows, y, numY, tables->rows, tables->ry );
+    }
+    else
+    {
+        qwtNearestIndexes( tables->xInterval, d_data->dx,
+            d_data->numColumns, x, numX, tables->cols );
+        qwtNearestIndexes( tables->yInterval, d_data->dy,
+            d_data->numRows, y, numY, tables->rows );
+    }
+
+    return tables;
+}
+
 /*!
    \return the value at a raster position
 
@@ -278,15 +751,131 @@ double QwtMatrixRasterData::value( double x, double y ) const
     return value;
 }
 
+/*!
+   \brief Values of a raster
+
+   Resamples the matrix like value(), but the indices of the matrix
+   are calculated once for each column and row of the raster.
+
+   \param x Array of x values in plot coordinates
+   \param numX Number of x values
+   \param y Array of y values in plot coordinates
+   \param numY Number of y values
+   \param values Buffer for at least numX * numY values
+
+   \sa value(), ResampleMode, rasterValues()
+*/
+void QwtMatrixRasterData::values( const double *x, int numX,
+    const double *y, int numY, double *values ) const
+{
+    if ( numX <= 0 || numY <= 0 )
+        return;
+
+    if ( d_data->numColumns <= 0 || d_data->numRows <= 0 )
+    {
+        qFill( values, values + numX * numY, qQNaN() );
+        return;
+    }
+
+    const QwtInterval xInterval = interval( Qt::XAxis );
+    const QwtInterval yInterval = interval( Qt::YAxis );
+
+    QVector<int> cols, rows;
+    QVector<double> rx, ry;
+
+    if ( d_data->resampleMode == BilinearInterpolation )
+    {
+        qwtBilinearIndexes( xInterval, d_data->dx, d_data->numColumns,
+            x, numX, cols, rx );
+        qwtBilinearIndexes( yInterval, d_data->dy, d_data->numRows,
+            y, numY, rows, ry );
+    }
+    else
+    {
+        qwtNearestIndexes( xInterval, d_data->dx, d_data->numColumns,
+            x, numX, cols );
+        qwtNearestIndexes( yInterval, d_data->dy, d_data->numRows,
+            y, numY, rows );
+    }
+
+    d_data->resample( rows.constData(), ry.constData(), numY,
+        cols.constData(), rx.constData(), numX, values );
+}
+
+/*!
+   \brief Values of a part of a raster
+
+   Resamples the matrix like values(), but takes the indices of the
+   matrix from the lookup tables, that have been calculated in
+   initRasterCoordinates(). When the matrix, its intervals or the
+   resample mode have been changed in between, the values are
+   resampled from the coordinates of the raster instead.
+
+   \param raster Raster returned from initRasterCoordinates()
+   \param col Index of the first column
+   \param numX Number of columns
+   \param row Index of the first row
+   \param numY Number of rows
+   \param values Buffer for at least numX * numY values
+
+   \sa values(), initRasterCoordinates()
+*/
+void QwtMatrixRasterData::rasterValues( const RasterCoordinates *raster,
+    int col, int numX, int row, int numY, double *values ) const
+{
+    if ( numX <= 0 || numY <= 0 )
+        return;
+
+    if ( d_data->numColumns <= 0 || d_data->numRows <= 0 )
+    {
+        qFill( values, values + numX * numY, qQNaN() );
+        return;
+    }
+
+    // the rasters of QwtMatrixRasterData are always lookup tables
+    const QwtMatrixRasterTables *tables =
+        static_cast<const QwtMatrixRasterTables *>( raster );
+
+    if ( tables->resampleMode != d_data->resampleMode
+        || tables->numColumns != d_data->numColumns
+        || tables->numRows != d_data->numRows
+        || tables->xInterval != interval( Qt::XAxis )
+        || tables->yInterval != interval( Qt::YAxis ) )
+    {
+        QwtRasterData::rasterValues( raster, col, numX, row, numY, values );
+        return;
+    }
+
+    if ( d_data->resampleMode == BilinearInterpolation )
+    {
+        d_data->resample(
+            tables->rows.constData() + 2 * row,
+            tables->ry.constData() + row, numY,
+            tables->cols.constData() + 2 * col,
+            tables->rx.constData() + col, numX, values );
+    }
+    else
+    {
+        d_data->resample(
+            tables->rows.constData() + row, NULL, numY,
+            tables->cols.constData() + col, NULL, numX, values );
+    }
+}
+
 void QwtMatrixRasterData::update()
 {
+    incrementRevision();
+
     d_data->numRows = 0;
     d_data->dx = 0.0;
     d_data->dy = 0.0;
 
     if ( d_data->numColumns > 0 )
     {
-        d_data->numRows = d_data->values.size() / d_data->numColumns;
+        if ( d_data->rawValues )
+            d_data->numRows = d_data->rawRows;
+        else
+            d_data->numRows = d_data->values.size() / d_data->numColumns;
 
         const QwtInterval xInterval = interval( Qt::XAxis );
         const QwtInterval yInterval = interval( Qt::YAxis );
@@ -21,6 +21,13 @@
   equidistant values, that can be used by a QwtPlotRasterItem. 
   It implements a couple of resampling algorithms, to provide
   values for positions, that or not on the value matrix.
+
+  Beside a matrix of doubles, it can display a matrix of integers
+  or floats in memory, that is owned by the application
+  ( f.e. the frames of a camera ). Then the values are resampled
+  without any conversion or copy of the matrix.
+
+  \sa setValueMatrix(), setRawMatrix()
 */
 class QWT_EXPORT QwtMatrixRasterData: public QwtRasterData
 {
@@ -44,6 +51,28 @@ public:
         BilinearInterpolation
     };
 
+    /*!
+      \brief Type of the values in a raw matrix
+      \sa setRawMatrix()
+     */
+    enum ValueType
+    {
+        //! 8 bit unsigned integer
+        UInt8,
+
+        //! 16 bit unsigned integer
+        UInt16,
+
+        //! 32 bit signed integer
+        Int32,
+
+        //! 32 bit floating point number
+        Float32,
+
+        //! 64 bit floating point number
+        Float64
+    };
+
     QwtMatrixRasterData();
     virtual ~QwtMatrixRasterData();
 
@@ -55,6 +84,16 @@ public:
     void setValueMatrix( const QVector<double> &values, int numColumns );
     const QVector<double> valueMatrix() const;
 
+    void setRawMatrix( const void *values, ValueType,
+        int numColumns, int numRows, int bytesPerLine = 0 );
+
+    bool hasRawMatrix() const;
+    ValueType valueType() const;
+
+    void setValueScale( double factor, double offset );
+    double valueScaleFactor() const;
+    double valueScaleOffset() const;
+
     void setValue( int row, int col, double value );
 
     int numColumns() const;
@@ -62,8 +101,17 @@ public:
 
     virtual QRectF pixelHint( const QRectF & ) const;
 
+    virtual RasterCoordinates *initRasterCoordinates(
+        const double *x, int numX, const double *y, int numY ) const;
+
     virtual double value( double x, double y ) const;
 
+    virtual void values( const double *x, int numX,
+        const double *y, int numY, double *values ) const;
+
+    virtual void rasterValues( const RasterCoordinates *,
+        int col, int numX, int row, int numY, double *values ) const;
+
 private:
     void update();
 
@@ -17,10 +17,17 @@
 #include "qwt_curve_fitter.h"
 #include "qwt_symbol.h"
 #include "qwt_point_mapper.h"
+#include "qwt_point_index.h"
 #include <qpainter.h>
 #include <qpixmap.h>
 #include <qalgorithms.h>
 #include <qmath.h>
+#include <qnumeric.h>
+
+#if QT_VERSION >= 0x040400 && !defined(QT_NO_QFUTURE)
+#include <qthread.h>
+#define QWT_USE_THREADS 1
+#endif
 
 static void qwtUpdateLegendIconSize( QwtPlotCurve *curve )
 {
@@ -45,6 +52,66 @@ static void qwtUpdateLegendIconSize( QwtPlotCurve *curve )
     }
 }
 
+// number of samples, that are mapped, clipped and drawn at once
+static const int qwtLineBatchSize = 65536;
+
+// QwtPointMapper maps polylines in parallel in chunks of at least
+// 50000 points. The batches need to be large enough to have
+// a chunk for each thread.
+static int qwtLineBatchSizeFor( uint numThreads )
+{
+    int batchSize = qwtLineBatchSize;
+
+#if QWT_USE_THREADS
+    if ( numThreads == 0 )
+        numThreads = QThread::idealThreadCount();
+
+    batchSize = qMax( batchSize, int( numThreads ) * 50000 );
+#else
+    Q_UNUSED( numThreads )
+#endif
+
+    return batchSize;
+}
+
+/*
+  Lines can be painted in batches, when nobody can see the borders
+  of the batches: the caps and joins of wide or translucent pens
+  would overlap, the pattern of a dashed pen would restart.
+ */
+static bool qwtCanDrawLineBatches( const QPainter *painter )
+{
+    if ( painter->opacity() < 1.0 )
+        return false;
+
+    const QPen pen = painter->pen();
+    if ( pen.style() != Qt::SolidLine )
+        return false;
+
+    const QBrush brush = pen.brush();
+    if ( brush.style() != Qt::SolidPattern || !brush.isOpaque() )
+        return false;
+
+    if ( !pen.isCosmetic() && painter->transform().isScaling() )
+        return false;
+
+    return pen.widthF() <= 1.0;
+}
+
+// draw the visible parts, that have been found by QwtClipper::clipPolyline()
+static void qwtDrawPolylineRuns( QPainter *painter,
+    const QPolygonF &points, const QVector<int> &runs )
+{
+    int from = 0;
+    for ( int i = 0; i < runs.size(); i++ )
+    {
+        QwtPainter::drawPolyline( painter,
+            points.constData() + from, runs[i] - from );
+
+        from = runs[i];
+    }
+}
+
 static int qwtVerifyRange( int size, int &i1, int &i2 )
 {
     if ( size < 1 )
@@ -59,6 +126,59 @@ static int qwtVerifyRange( int size, int &i1, int &i2 )
     return ( i2 - i1 + 1 );
 }
 
+/*
+  Narrow [from, to] to the samples inside the x interval
+  of [x1, x2] ( in paint device coordinates ) - including one
+  neighbour on each side. The samples need to have increasing
+  x coordinates.
+ */
+static void qwtVisibleRange( const QwtSeriesData<QPointF> &series,
+    const QwtScaleMap &xMap, double x1, double x2, int &from, int &to )
+{
+    double v1 = xMap.invTransform( x1 );
+    double v2 = xMap.invTransform( x2 );
+
+    if ( v1 > v2 )
+        qSwap( v1, v2 );
+
+    if ( !( v1 <= v2 ) )
+        return; // NaN
+
+    // index of the first sample >= v1
+
+    int lower = from;
+    int upper = to + 1;
+
+    while ( lower < upper )
+    {
+        const int mid = lower + ( upper - lower ) / 2;
+        if ( series.sample( mid ).x() < v1 )
+            lower = mid + 1;
+        else
+            upper = mid;
+    }
+
+    const int first = lower;
+
+    // index of the first sample > v2
+
+    upper = to + 1;
+
+    while ( lower < upper )
+    {
+        const int mid = lower + ( upper - lower ) / 2;
+        if ( series.sample( mid ).x() <= v2 )
+            lower = mid + 1;
+        else
+            upper = mid;
+    }
+
+    const int last = lower;
+
+    from = qMax( from, first - 1 );
+    to = qMin( to, last );
+}
+
 class QwtPlotCurve::PrivateData
 {
 public:
@@ -66,6 +186,14 @@ public:
         style( QwtPlotCurve::Lines ),
         baseline( 0.0 ),
         symbol( NULL ),
+        pointIndex( NULL ),
+        sampleOrder( QwtPlotCurve::UnorderedSamples ),
+        orderedSeries( NULL ),
+        orderedSize( 0 ),
+        orderedRevision( 0 ),
+        increasingX( false ),
+        firstX( 0.0 ),
+        lastX( 0.0 ),
         attributes( 0 ),
         paintAttributes( 
             QwtPlotCurve::ClipPolygons | QwtPlotCurve::FilterPoints ),
@@ -79,6 +207,7 @@ public:
     {
         delete symbol;
         delete curveFitter;
+        delete pointIndex;
     }
 
     QwtPlotCurve::CurveStyle style;
@@ -86,6 +215,17 @@ public:
 
     const QwtSymbol *symbol;
     QwtCurveFitter *curveFitter;
+    QwtPointIndex *pointIndex;
+
+    QwtPlotCurve::SampleOrder sampleOrder;
+
+    // cached result of detecting the sample order
+    const QwtSeriesData<QPointF> *orderedSeries;
+    size_t orderedSize;
+    uint orderedRevision;
+    bool increasingX;
+    double firstX;
+    double lastX;
 
     QPen pen;
     QBrush brush;
@@ -94,6 +234,21 @@ public:
     QwtPlotCurve::PaintAttributes paintAttributes;
 
     QwtPlotCurve::LegendAttributes legendAttributes;
+
+    // buffers for clipping the lines, reused across replots
+    QPolygonF clippedPoints;
+    QVector<int> clippedRuns;
+
+    void trimClipBuffers( int batchSize = qwtLineBatchSize )
+    {
+        // buffers, that have been used for a curve in one piece,
+        // would keep a lot of memory
+        if ( clippedPoints.capacity() > 4 * batchSize )
+            clippedPoints = QPolygonF();
+
+        if ( clippedRuns.capacity() > 4 * batchSize )
+            clippedRuns = QVector<int>();
+    }
 };
 
 /*!
@@ -343,7 +498,10 @@ const QBrush& QwtPlotCurve::brush() const
   \param to Index of the last point to be painted. If to < 0 the
          curve will be painted to its last point.
 
-  \sa drawCurve(), drawSymbols(),
+  \note For samples with increasing x coordinates the interval 
+        is reduced to the samples inside of the canvas.
+
+  \sa drawCurve(), drawSymbols(), setSampleOrder()
 */
 void QwtPlotCurve::drawSeries( QPainter *painter,
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
@@ -359,6 +517,24 @@ void QwtPlotCurve::drawSeries( QPainter *painter,
 
     if ( qwtVerifyRange( numSamples, from, to ) > 0 )
     {
+        if ( hasIncreasingX() )
+        {
+            // symbols or wide pens of samples outside 
+            // might reach into the canvas
+
+            double margin = d_data->pen.widthF();
+            if ( d_data->symbol &&
+                ( d_data->symbol->style() != QwtSymbol::NoSymbol ) )
+            {
+                margin = qMax( margin, 
+                    qreal( d_data->symbol->boundingRect().width() ) );
+            }
+            margin += 1.0;
+
+            qwtVisibleRange( *data(), xMap, canvasRect.left() - margin,
+                canvasRect.right() + margin, from, to );
+        }
+
         painter->save();
         painter->setPen( d_data->pen );
 
@@ -430,6 +606,18 @@ void QwtPlotCurve::drawCurve( QPainter *painter, int style,
   If the CurveAttribute Fitted is enabled a QwtCurveFitter tries
   to interpolate/smooth the curve, before it is painted.
 
+  Curves, that are not filled, are mapped, clipped and painted in
+  batches of samples. So the memory needed for painting is bounded,
+  no matter how many samples are displayed. This includes fitted
+  curves, when the fitter is local ( QwtCurveFitter::isLocal() ),
+  like QwtWeedingCurveFitter. The size of the batches grows with
+  renderThreadCount(), so that each batch is mapped in parallel.
+
+  As each batch is painted by a separate polyline, batches are only
+  used for opaque, solid pens with a width of up to 1 pixel. Otherwise
+  the caps and joins would overlap or the pattern of a dashed
+  pen would restart at the borders of the batches.
+
   \param painter Painter
   \param xMap x map
   \param yMap y map
@@ -479,16 +667,18 @@ void QwtPlotCurve::drawLines( QPainter *painter,
 #endif
 
     const bool noDuplicates = d_data->paintAttributes & FilterPoints;
+    const bool minMaxOnly = d_data->paintAttributes & FilterPointsAggressive;
 
     QwtPointMapper mapper;
     mapper.setFlag( QwtPointMapper::RoundPoints, doAlign );
     mapper.setFlag( QwtPointMapper::WeedOutPoints, noDuplicates );
+    mapper.setFlag( QwtPointMapper::WeedOutIntermediatePoints, minMaxOnly );
     mapper.setBoundingRect( canvasRect );
 
     if ( doIntegers )
     {
         QPolygon polyline = mapper.toPolygon( 
-            xMap, yMap, data(), from, to );
+            xMap, yMap, data(), from, to, renderThreadCount() );
 
         if ( d_data->paintAttributes & ClipPolygons )
         {
@@ -498,30 +688,90 @@ void QwtPlotCurve::drawLines( QPainter *painter,
 
         QwtPainter::drawPolyline( painter, polyline );
     }
+    else if ( !doFill && ( !doFit || d_data->curveFitter->isLocal() )
+        && qwtCanDrawLineBatches( painter ) )
+    {
+        /*
+          The curve is mapped, fitted, clipped and drawn in batches,
+          what limits the memory for the points and the size of the
+          paths, that have to be stroked. The batches overlap by one
+          sample, so that the line is continuous.
+         */
+        const int batchSize = qwtLineBatchSizeFor( renderThreadCount() );
+
+        for ( int i = from; ; )
+        {
+            const int last = qMin( i + batchSize, to );
+
+            QPolygonF polyline = mapper.toPolygonF(
+                xMap, yMap, data(), i, last, renderThreadCount() );
+
+            if ( doFit )
+                polyline = d_data->curveFitter->fitCurve( polyline );
+
+            if ( d_data->paintAttributes & ClipPolygons )
+            {
+                QwtClipper::clipPolyline( clipRect,
+                    polyline.constData(), polyline.size(),
+                    d_data->clippedPoints, d_data->clippedRuns );
+
+                qwtDrawPolylineRuns( painter,
+                    d_data->clippedPoints, d_data->clippedRuns );
+            }
+            else
+            {
+                QwtPainter::drawPolyline( painter, polyline );
+            }
+
+            if ( last >= to )
+                break;
+
+            i = last;
+        }
+
+        d_data->trimClipBuffers( batchSize );
+    }
     else
     {
-        QPolygonF polyline = mapper.toPolygonF( xMap, yMap, data(), from, to );
+        QPolygonF polyline = mapper.toPolygonF(
+            xMap, yMap, data(), from, to, renderThreadCount() );
 
         if ( doFit )
             polyline = d_data->curveFitter->fitCurve( polyline );
 
-        if ( doFill )
+        const bool doStroke = painter->pen().style() != Qt::NoPen;
+
+        if ( d_data->paintAttributes & ClipPolygons )
         {
-            if ( painter->pen().style() != Qt::NoPen )
+            // the visible parts of the line are clipped, before
+            // fillCurve() modifies the polyline
+
+            if ( doStroke )
             {
-                // here we are wasting memory for the filled copy,
-                // do polygon clipping twice etc .. TODO
+                QwtClipper::clipPolyline( clipRect,
+                    polyline.constData(), polyline.size(),
+                    d_data->clippedPoints, d_data->clippedRuns );
+            }
+
+            if ( doFill )
+                fillCurve( painter, xMap, yMap, canvasRect, polyline );
+
+            if ( doStroke )
+            {
+                qwtDrawPolylineRuns( painter,
+                    d_data->clippedPoints, d_data->clippedRuns );
+            }
 
+            d_data->trimClipBuffers();
+        }
+        else if ( doFill )
+        {
+            if ( doStroke )
+            {
                 QPolygonF filled = polyline;
                 fillCurve( painter, xMap, yMap, canvasRect, filled );
                 filled.clear();
 
-                if ( d_data->paintAttributes & ClipPolygons )
-                {
-                    polyline = QwtClipper::clipPolygonF( 
-                        clipRect, polyline, false );
-                }
-
                 QwtPainter::drawPolyline( painter, polyline );
             }
             else
@@ -531,12 +781,6 @@ void QwtPlotCurve::drawLines( QPainter *painter,
         }
         else
         {
-            if ( d_data->paintAttributes & ClipPolygons )
-            {
-                polyline = QwtClipper::clipPolygonF(
-                    clipRect, polyline, false );
-            }
-
             QwtPainter::drawPolyline( painter, polyline );
         }
     }
@@ -573,11 +817,11 @@ void QwtPlotCurve::drawSticks( QPainter *painter,
 
     const Qt::Orientation o = orientation();
 
-    const QwtSeriesData<QPointF> *series = data();
+    QwtSeriesReader<QPointF> reader( data(), from, to );
 
     for ( int i = from; i <= to; i++ )
     {
-        const QPointF sample = series->sample( i );
+        const QPointF &sample = reader.sample( i );
         double xi = xMap.transform( sample.x() );
         double yi = yMap.transform( sample.y() );
         if ( doAlign )
@@ -656,11 +900,11 @@ void QwtPlotCurve::drawDots( QPainter *painter,
     }
     else if ( d_data->paintAttributes & MinimizeMemory )
     {
-        const QwtSeriesData<QPointF> *series = data();
+        QwtSeriesReader<QPointF> reader( data(), from, to );
 
         for ( int i = from; i <= to; i++ )
         {
-            const QPointF sample = series->sample( i );
+            const QPointF &sample = reader.sample( i );
 
             double xi = xMap.transform( sample.x() );
             double yi = yMap.transform( sample.y() );
@@ -721,12 +965,12 @@ void QwtPlotCurve::drawSteps( QPainter *painter,
     if ( d_data->attributes & Inverted )
         inverted = !inverted;
 
-    const QwtSeriesData<QPointF> *series = data();
+    QwtSeriesReader<QPointF> reader( data(), from, to );
 
     int i, ip;
     for ( i = from, ip = 0; i <= to; i++, ip += 2 )
     {
-        const QPointF sample = series->sample( i );
+        const QPointF &sample = reader.sample( i );
         double xi = xMap.transform( sample.x() );
         double yi = yMap.transform( sample.y() );
         if ( doAlign )
@@ -1005,8 +1249,10 @@ double QwtPlotCurve::baseline() const
               the position and the closest curve point
   \return Index of the closest curve point, or -1 if none can be found
           ( f.e when the curve has no points )
-  \note closestPoint() implements a dumb algorithm, that iterates
-        over all points
+  \note Without a point index closestPoint() implements a dumb algorithm,
+        that iterates over all points
+
+  \sa setPointIndexEnabled()
 */
 int QwtPlotCurve::closestPoint( const QPoint &pos, double *dist ) const
 {
@@ -1015,17 +1261,23 @@ int QwtPlotCurve::closestPoint( const QPoint &pos, double *dist ) const
     if ( plot() == NULL || numSamples <= 0 )
         return -1;
 
-    const QwtSeriesData<QPointF> *series = data();
-
     const QwtScaleMap xMap = plot()->canvasMap( xAxis() );
     const QwtScaleMap yMap = plot()->canvasMap( yAxis() );
 
+    if ( d_data->pointIndex )
+    {
+        return d_data->pointIndex->closestPoint( 
+            data(), xMap, yMap, pos, dist );
+    }
+
+    QwtSeriesReader<QPointF> reader( data(), 0, int( numSamples ) - 1 );
+
     int index = -1;
     double dmin = 1.0e10;
 
-    for ( uint i = 0; i < numSamples; i++ )
+    for ( int i = 0; i < int( numSamples ); i++ )
     {
-        const QPointF sample = series->sample( i );
+        const QPointF &sample = reader.sample( i );
 
         const double cx = xMap.transform( sample.x() ) - pos.x();
         const double cy = yMap.transform( sample.y() ) - pos.y();
@@ -1043,6 +1295,173 @@ int QwtPlotCurve::closestPoint( const QPoint &pos, double *dist ) const
     return index;
 }
 
+/*!
+  \brief En/Disable a spatial index for closestPoint()
+
+  For large series, where closestPoint() is called often
+  ( f.e. by pickers tracking the mouse ), a brute force search
+  over all points is too slow. When the index is enabled, it is
+  built lazily from the samples in scale coordinates, when
+  closestPoint() is called for the first time, and it remains valid
+  until the series, its size or its QwtSeriesData::revision()
+  has changed.
+
+  The index is disabled by default, as it needs additional memory:
+  24 bytes for each sample of a series without increasing x values
+  ( the position and the index of each sample in a k-d tree ),
+  but only 32 bytes for each chunk of 64 samples otherwise.
+
+  \param on On/Off
+  \sa isPointIndexEnabled(), closestPoint(), QwtPointIndex, dataChanged()
+*/
+void QwtPlotCurve::setPointIndexEnabled( bool on )
+{
+    if ( on == ( d_data->pointIndex != NULL ) )
+        return;
+
+    if ( on )
+    {
+        d_data->pointIndex = new QwtPointIndex();
+    }
+    else
+    {
+        delete d_data->pointIndex;
+        d_data->pointIndex = NULL;
+    }
+}
+
+/*!
+  \return True, when closestPoint() uses a spatial index
+  \sa setPointIndexEnabled()
+*/
+bool QwtPlotCurve::isPointIndexEnabled() const
+{
+    return d_data->pointIndex != NULL;
+}
+
+/*!
+  \brief Set the order of the samples
+
+  When the samples have increasing x coordinates, drawSeries() 
+  paints only the range of samples, that is inside the canvas.
+  Declaring the order avoids the costs of detecting it, whenever 
+  the series has changed.
+
+  DetectOrder relies on QwtSeriesData::revision(): samples, that are
+  modified in place without incrementing the revision ( f.e. the
+  buffers of setRawSamples() ), are painted incompletely, when they
+  are not increasing anymore. For series, that increment the revision
+  for each replot ( like QwtCircularPointData ), the samples are
+  checked for each replot.
+
+  \param order Sample order
+  \sa sampleOrder(), drawSeries()
+
+  \note The default setting is UnorderedSamples
+*/
+void QwtPlotCurve::setSampleOrder( SampleOrder order )
+{
+    if ( order != d_data->sampleOrder )
+    {
+        d_data->sampleOrder = order;
+        itemChanged();
+    }
+}
+
+/*!
+  \return Order of the samples
+  \sa setSampleOrder()
+*/
+QwtPlotCurve::SampleOrder QwtPlotCurve::sampleOrder() const
+{
+    return d_data->sampleOrder;
+}
+
+/*!
+  \return True, when the samples have increasing x coordinates
+  \sa setSampleOrder()
+*/
+bool QwtPlotCurve::hasIncreasingX() const
+{
+    if ( d_data->sampleOrder == IncreasingX )
+        return true;
+
+    if ( d_data->sampleOrder == UnorderedSamples )
+        return false;
+
+    const QwtSeriesData<QPointF> *series = data();
+    const int numSamples = static_cast<int>( dataSize() );
+
+    if ( numSamples <= 0 )
+        return false;
+
+    if ( series == d_data->orderedSeries && 
+        size_t( numSamples ) == d_data->orderedSize &&
+        series->revision() == d_data->orderedRevision )
+    {
+        return d_data->increasingX;
+    }
+
+    int from = 0;
+
+    const int numOrdered = static_cast<int>( d_data->orderedSize );
+    if ( series == d_data->orderedSeries && d_data->increasingX
+        && numSamples > numOrdered && numOrdered > 0 )
+    {
+        // When samples have been appended it is
+        // good enough to check the new ones
+
+        if ( series->sample( 0 ).x() == d_data->firstX &&
+            series->sample( numOrdered - 1 ).x() == d_data->lastX )
+        {
+            from = numOrdered - 1;
+        }
+    }
+
+    QwtSeriesReader<QPointF> reader( series, from, numSamples - 1 );
+
+    double x0 = reader.sample( from ).x();
+    bool increasing = !qIsNaN( x0 );
+
+    for ( int i = from + 1; increasing && i < numSamples; i++ )
+    {
+        const double x = reader.sample( i ).x();
+
+        // also fails for NaN values
+        if ( !( x >= x0 ) )
+            increasing = false;
+
+        x0 = x;
+    }
+
+    d_data->orderedSeries = series;
+    d_data->orderedSize = numSamples;
+    d_data->orderedRevision = series->revision();
+    d_data->increasingX = increasing;
+    d_data->firstX = series->sample( 0 ).x();
+    d_data->lastX = x0;
+
+    return increasing;
+}
+
+/*!
+  \brief Invalidate cached information about the samples 
+         and update the plot
+
+  dataChanged() is called, when the series has been replaced.
+
+  \sa setPointIndexEnabled(), QwtPlotSeriesItem::dataChanged()
+*/
+void QwtPlotCurve::dataChanged()
+{
+    if ( d_data->pointIndex )
+        d_data->pointIndex->invalidate();
+
+    d_data->orderedSeries = NULL;
+
+    QwtPlotSeriesItem::dataChanged();
+}
+
 /*!
    \return Icon representing the curve on the legend
 
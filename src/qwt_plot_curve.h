@@ -131,6 +131,36 @@ public:
     //! Curve attributes
     typedef QFlags<CurveAttribute> CurveAttributes;
 
+    /*!
+      Order of the x coordinates of the samples
+
+      For samples with increasing x coordinates only the range of
+      samples, that covers the interval of the x axis, needs to be
+      painted. This range can be found by a binary search, so that 
+      painting a small part of a huge series is fast.
+
+      \sa setSampleOrder(), sampleOrder()
+     */
+    enum SampleOrder
+    {
+        /*!
+          The order is detected by iterating over the samples,
+          whenever the data has been changed. The result is cached
+          until the series is replaced or its size or
+          QwtSeriesData::revision() has changed.
+         */
+        DetectOrder,
+
+        /*!
+          The x coordinates are declared to be increasing 
+          without checking them.
+         */
+        IncreasingX,
+
+        //! The samples are always painted completely ( default ).
+        UnorderedSamples
+    };
+
     /*!
         Attributes how to represent the curve on the legend
 
@@ -204,7 +234,22 @@ public:
           With a reasonable number of points QPainter::drawPoints()
           will be faster.
          */
-        ImageBuffer = 0x08
+        ImageBuffer = 0x08,
+
+        /*!
+          An even more aggressive weeding algorithm for the Lines style,
+          that can be used when having a huge amount of points.
+
+          A consecutive chunk of points being mapped to the same
+          x coordinate is reduced to the first point, the points
+          with the minimum and maximum y coordinates and the last point.
+          The result looks the same as drawing all points, but
+          the number of points to be painted is limited to 
+          4 times the width of the canvas.
+
+          \sa QwtPointMapper::WeedOutIntermediatePoints
+         */
+        FilterPointsAggressive = 0x10
     };
 
     //! Paint attributes
@@ -233,6 +278,12 @@ public:
 
     int closestPoint( const QPoint &pos, double *dist = NULL ) const;
 
+    void setPointIndexEnabled( bool on );
+    bool isPointIndexEnabled() const;
+
+    void setSampleOrder( SampleOrder );
+    SampleOrder sampleOrder() const;
+
     double minXValue() const;
     double maxXValue() const;
     double minYValue() const;
@@ -270,6 +321,8 @@ protected:
 
     void init();
 
+    virtual void dataChanged();
+
     virtual void drawCurve( QPainter *p, int style,
         const QwtScaleMap &xMap, const QwtScaleMap &yMap,
         const QRectF &canvasRect, int from, int to ) const;
@@ -301,6 +354,8 @@ protected:
     void closePolyline( QPainter *,
         const QwtScaleMap &, const QwtScaleMap &, QPolygonF & ) const;
 
+    bool hasIncreasingX() const;
+
 private:
     class PrivateData;
     PrivateData *d_data;
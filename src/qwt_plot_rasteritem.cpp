@@ -10,6 +10,9 @@
 #include "qwt_plot_rasteritem.h"
 #include "qwt_scale_map.h"
 #include "qwt_painter.h"
+#include "qwt_plot.h"
+#include "qwt_plot_canvas.h"
+#include "qwt_raster_tile_scheduler.h"
 #include <qapplication.h>
 #include <qdesktopwidget.h>
 #include <qpainter.h>
@@ -19,8 +22,78 @@
 #include <qthread.h>
 #include <qfuture.h>
 #include <qtconcurrentrun.h>
+#include <qfuturewatcher.h>
+#include <qmutex.h>
+#include <qatomic.h>
 #endif
+#include <qtimer.h>
+#include <qdebug.h>
+#include <qcache.h>
+#include <qhash.h>
 #include <float.h>
+#include <string.h>
+
+#if QT_VERSION >= 0x040400 && !defined(QT_NO_QFUTURE)
+#define QWT_ASYNC_RENDERING 1
+#endif
+
+// width/height of the tiles of the TileCache in pixels
+static const int qwtTileSize = 256;
+
+/*
+  Position of a tile in a grid, that is aligned to the scale
+  coordinates. Each tile has qwtTileSize x qwtTileSize pixels
+  of pixelWidth x pixelHeight in scale coordinates.
+ */
+class QwtRasterTileKey
+{
+public:
+    QwtRasterTileKey( double width = 0.0, double height = 0.0,
+            int c = 0, int r = 0 ):
+        pixelWidth( width ),
+        pixelHeight( height ),
+        col( c ),
+        row( r )
+    {
+    }
+
+    inline bool operator==( const QwtRasterTileKey &other ) const
+    {
+        return col == other.col && row == other.row
+            && pixelWidth == other.pixelWidth
+            && pixelHeight == other.pixelHeight;
+    }
+
+    double pixelWidth;
+    double pixelHeight;
+    int col;
+    int row;
+};
+
+// size of a pixel rounded to zoom levels in steps of 2^(1/8)
+static inline double qwtZoomLevelSize( double size )
+{
+    const double level = qRound( 8.0 * qLn( size ) / qLn( 2.0 ) ) / 8.0;
+    return qPow( 2.0, level );
+}
+
+static inline uint qwtHashDouble( double value )
+{
+    quint64 bits;
+    ::memcpy( &bits, &value, sizeof( bits ) );
+
+    return qHash( bits );
+}
+
+inline uint qHash( const QwtRasterTileKey &key )
+{
+    uint hash = qwtHashDouble( key.pixelWidth );
+    hash = 31 * hash + qwtHashDouble( key.pixelHeight );
+    hash = 31 * hash + uint( key.col );
+    hash = 31 * hash + uint( key.row );
+
+    return hash;
+}
 
 class QwtPlotRasterItem::PrivateData
 {
@@ -30,6 +103,181 @@ public:
         paintAttributes( QwtPlotRasterItem::PaintInDeviceResolution )
     {
         cache.policy = QwtPlotRasterItem::NoCache;
+        tileCache.tiles.setMaxCost( 64 * 1024 ); // 64MB
+
+#if QWT_ASYNC_RENDERING
+        async.job = NULL;
+        tileCache.pending = NULL;
+        runningJob = NULL;
+
+        replotTimer.setSingleShot( true );
+        replotTimer.setInterval( 0 );
+#endif
+    }
+
+    ~PrivateData()
+    {
+        cancelImage();
+        cancelCacheTiles();
+
+#if QWT_ASYNC_RENDERING
+        // no job must survive the item
+        waitForJobs();
+#endif
+    }
+
+#if QWT_ASYNC_RENDERING
+    // rendering an image or a tile in a background thread
+    class Job
+    {
+    public:
+        Job( const QwtPlotRasterItem *rasterItem,
+                const QwtScaleMap &xScaleMap, const QwtScaleMap &yScaleMap,
+                const QRectF &imageArea, const QSize &imageSize ):
+            item( rasterItem ),
+            xMap( xScaleMap ),
+            yMap( yScaleMap ),
+            area( imageArea ),
+            size( imageSize ),
+            cancelled( 0 )
+        {
+        }
+
+        const QwtPlotRasterItem *item;
+        QwtScaleMap xMap;
+        QwtScaleMap yMap;
+        QRectF area;
+        QSize size;
+
+        QAtomicInt cancelled;
+        QFutureWatcher<QImage> watcher;
+    };
+
+    /*
+      Start a job, that renders in a background thread. All jobs,
+      that finish in the same cycle of the event loop, result
+      in one replot.
+     */
+    Job *start( const QwtPlotRasterItem *item,
+        const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QRectF &area, const QSize &size )
+    {
+        removeFinishedJobs();
+
+        replotTimer.disconnect();
+        if ( item->plot() )
+        {
+            QObject::connect( &replotTimer, SIGNAL( timeout() ),
+                item->plot(), SLOT( replot() ) );
+        }
+
+        Job *job = new Job( item, xMap, yMap, area, size );
+        QObject::connect( &job->watcher, SIGNAL( finished() ),
+            &replotTimer, SLOT( start() ) );
+
+        job->watcher.setFuture(
+            QtConcurrent::run( &PrivateData::runJob, this, job ) );
+
+        return job;
+    }
+
+    /*
+      The jobs are running one after the other, so that the
+      raster data is never accessed by 2 jobs at the same time.
+      Jobs, that have been cancelled before, return without rendering.
+     */
+    static QImage runJob( PrivateData *d, Job *job )
+    {
+        QMutexLocker jobLocker( &d->jobMutex );
+
+        if ( job->cancelled.fetchAndAddRelaxed( 0 ) != 0 )
+            return QImage();
+
+        d->jobStateMutex.lock();
+        d->runningJob = job;
+        d->jobStateMutex.unlock();
+
+        const QImage image = job->item->renderImage(
+            job->xMap, job->yMap, job->area, job->size );
+
+        d->jobStateMutex.lock();
+        d->runningJob = NULL;
+        d->jobStateMutex.unlock();
+
+        return image;
+    }
+
+    /*
+      Cancel a job without waiting for it. Its result is dropped,
+      and it is deleted, when it has finished.
+     */
+    void cancel( Job *job )
+    {
+        job->watcher.disconnect();
+        job->cancelled.fetchAndStoreRelaxed( 1 );
+
+        jobStateMutex.lock();
+
+        // a running renderImage() returns, as soon as the tiles
+        // of the scheduler, that are in progress, are completed
+        if ( runningJob == job )
+            scheduler.cancel();
+
+        jobStateMutex.unlock();
+
+        cancelledJobs += job;
+        removeFinishedJobs();
+    }
+
+    void removeFinishedJobs()
+    {
+        for ( int i = cancelledJobs.size() - 1; i >= 0; i-- )
+        {
+            if ( cancelledJobs[i]->watcher.isFinished() )
+                delete cancelledJobs.takeAt( i );
+        }
+    }
+
+    // wait until no job is running, f.e. before accessing the data
+    void waitForJobs()
+    {
+        if ( async.job )
+            async.job->watcher.waitForFinished();
+
+        if ( tileCache.pending )
+            tileCache.pending->watcher.waitForFinished();
+
+        for ( int i = 0; i < cancelledJobs.size(); i++ )
+            cancelledJobs[i]->watcher.waitForFinished();
+
+        qDeleteAll( cancelledJobs );
+        cancelledJobs.clear();
+    }
+#endif
+
+    void cancelImage()
+    {
+#if QWT_ASYNC_RENDERING
+        if ( async.job )
+        {
+            cancel( async.job );
+            async.job = NULL;
+        }
+#endif
+        async.area = QRectF();
+        async.size = QSize();
+        async.image = QImage();
+    }
+
+    void cancelCacheTiles()
+    {
+#if QWT_ASYNC_RENDERING
+        if ( tileCache.pending )
+        {
+            cancel( tileCache.pending );
+            tileCache.pending = NULL;
+        }
+#endif
     }
 
     int alpha;
@@ -42,7 +290,57 @@ public:
         QRectF area;
         QSizeF size;
         QImage image;
+
+        // parts of area, that need to be rendered again
+        QRectF dirtyArea;
     } cache;
+
+    struct TileCache
+    {
+        // cost in KB
+        QCache<QwtRasterTileKey, QImage> tiles;
+
+#if QWT_ASYNC_RENDERING
+        // the tile being rendered in a background thread
+        QwtRasterTileKey pendingKey;
+        Job *pending;
+#endif
+    } tileCache;
+
+    struct AsyncRendering
+    {
+        // the requested image
+        QRectF area;
+        QSize size;
+
+#if QWT_ASYNC_RENDERING
+        // rendering the requested image in a background thread
+        Job *job;
+#endif
+
+        // completed image for area/size
+        QImage image;
+
+        // last completed image, used until the tiles are available
+        QImage preview;
+        QRectF previewArea;
+    } async;
+
+    QwtRasterTileScheduler scheduler;
+
+#if QWT_ASYNC_RENDERING
+    QTimer replotTimer;
+
+    // cancelled jobs, that might still be running
+    QList<Job *> cancelledJobs;
+
+    // held by the job, that is rendering
+    QMutex jobMutex;
+
+    // guards runningJob
+    QMutex jobStateMutex;
+    Job *runningJob;
+#endif
 };
 
 
@@ -363,7 +661,7 @@ static bool qwtUseCache( QwtPlotRasterItem::CachePolicy policy,
 {
     bool doCache = false;
 
-    if ( policy == QwtPlotRasterItem::PaintCache )
+    if ( policy != QwtPlotRasterItem::NoCache )
     {
         // Caching doesn't make sense, when the item is
         // not painted to screen
@@ -384,6 +682,98 @@ static bool qwtUseCache( QwtPlotRasterItem::CachePolicy policy,
     return doCache;
 }
 
+static bool qwtIsCanvasDevice( const QwtPlot *plot, const QPainter *painter )
+{
+    if ( plot == NULL )
+        return false;
+
+    const QPaintDevice *device = painter->device();
+
+    const QWidget *canvas = plot->canvas();
+    if ( device == canvas )
+        return true;
+
+    const QwtPlotCanvas *plotCanvas = qobject_cast<const QwtPlotCanvas *>( canvas );
+    if ( plotCanvas && plotCanvas->backingStore() == device )
+        return true;
+
+    return false;
+}
+
+/*
+  The area of a tile, that results in the same scale maps
+  for the pixels of the tile as the maps of the complete image.
+  See QwtPlotRasterItem::imageMap().
+ */
+static QRectF qwtTileArea( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QRect &tile, double dx, double dy )
+{
+    double x1, x2;
+    if ( dx > 0.0 )
+    {
+        const double off = xMap.isInverting() ? -0.5 * dx : 0.5 * dx;
+
+        x1 = xMap.invTransform( tile.left() ) - off;
+        x2 = xMap.invTransform( tile.right() + 1 ) - off;
+    }
+    else
+    {
+        x1 = xMap.invTransform( tile.left() );
+        x2 = xMap.invTransform( tile.right() );
+    }
+
+    double y1, y2;
+    if ( dy > 0.0 )
+    {
+        const double off = yMap.isInverting() ? -0.5 * dy : 0.5 * dy;
+
+        y1 = yMap.invTransform( tile.top() ) - off;
+        y2 = yMap.invTransform( tile.bottom() + 1 ) - off;
+    }
+    else
+    {
+        y1 = yMap.invTransform( tile.top() );
+        y2 = yMap.invTransform( tile.bottom() );
+    }
+
+    return QRectF( QPointF( x1, y1 ), QPointF( x2, y2 ) ).normalized();
+}
+
+/*
+  A rectangle, that includes the area of a tile of the TileCache.
+  The grid of the tiles might be shifted by less than a pixel,
+  see QwtPlotRasterItem::composeTiles().
+ */
+static QRectF qwtTileRect( const QwtRasterTileKey &key )
+{
+    const double pw = key.pixelWidth;
+    const double ph = key.pixelHeight;
+
+    const double tw = qwtTileSize * pw;
+    const double th = qwtTileSize * ph;
+
+    return QRectF( key.col * tw - pw, key.row * th - ph,
+        tw + 2 * pw, th + 2 * ph );
+}
+
+// copy the pixels of an image of the same format into rect of target
+static void qwtCopyPixels( const QImage &image, QImage &target,
+    const QPoint &pos, const QRect &rect )
+{
+    const int bytesPerPixel = target.depth() / 8;
+    const int numBytes = rect.width() * bytesPerPixel;
+
+    for ( int y = 0; y < rect.height(); y++ )
+    {
+        const uchar *from = image.scanLine( pos.y() + y )
+            + pos.x() * bytesPerPixel;
+        uchar *to = target.scanLine( rect.top() + y )
+            + rect.left() * bytesPerPixel;
+
+        ::memcpy( to, from, numBytes );
+    }
+}
+
 static void qwtToRgba( const QImage* from, QImage* to,  
     const QRect& tile, int alpha )
 {
@@ -440,7 +830,17 @@ QwtPlotRasterItem::QwtPlotRasterItem( const QwtText& title ):
     init();
 }
 
-//! Destructor
+/*!
+  \brief Destructor
+
+  Images, that are rendered in background threads, are cancelled
+  and waited for.
+
+  \note As the destructor of a derived class has been completed
+        before, derived classes, where renderImage() accesses
+        their members, have to call invalidateCache() in their
+        destructor - like QwtPlotSpectrogram does.
+*/
 QwtPlotRasterItem::~QwtPlotRasterItem()
 {
     delete d_data;
@@ -469,6 +869,9 @@ void QwtPlotRasterItem::setPaintAttribute( PaintAttribute attribute, bool on )
         d_data->paintAttributes |= attribute;
     else
         d_data->paintAttributes &= ~attribute;
+
+    if ( attribute == AsynchronousRendering && !on )
+        invalidateCache();
 }
 
 /*!
@@ -559,13 +962,133 @@ QwtPlotRasterItem::CachePolicy QwtPlotRasterItem::cachePolicy() const
 
 /*!
    Invalidate the paint cache
-   \sa setCachePolicy()
+
+   Rendering in background threads is cancelled and
+   running threads are waited for, so that the data, that is
+   needed for rendering, can be modified or deleted afterwards.
+
+   \sa setCachePolicy(), AsynchronousRendering
 */
 void QwtPlotRasterItem::invalidateCache()
 {
+    // images, that are rendered in background threads, are aborted
+    d_data->cancelImage();
+    d_data->async.preview = QImage();
+    d_data->async.previewArea = QRectF();
+
+    d_data->cancelCacheTiles();
+    d_data->tileCache.tiles.clear();
+
+#if QWT_ASYNC_RENDERING
+    d_data->waitForJobs();
+#endif
+
     d_data->cache.image = QImage();
     d_data->cache.area = QRect();
     d_data->cache.size = QSize();
+    d_data->cache.dirtyArea = QRectF();
+}
+
+/*!
+   \brief Invalidate the cached image for an area
+
+   When only a part of the data has been modified ( f.e. a new row
+   of a waterfall display ) the cached images are kept and only the
+   pixels of the area are rendered again.
+
+   \param area Area in scale coordinates
+
+   \note Rendering in background threads is cancelled without
+         waiting for it. Tiles of the TileCache are dropped,
+         when they intersect with area.
+   \sa invalidateCache(), setCachePolicy()
+*/
+void QwtPlotRasterItem::invalidateCacheArea( const QRectF &area )
+{
+    const QRectF rect = area.normalized();
+    if ( rect.isNull() )
+        return;
+
+    PrivateData::ImageCache &cache = d_data->cache;
+
+    const QRectF dirtyArea = rect & cache.area;
+    if ( !dirtyArea.isEmpty() )
+        cache.dirtyArea |= dirtyArea;
+
+    d_data->cancelImage();
+
+    PrivateData::TileCache &tileCache = d_data->tileCache;
+
+    const QList<QwtRasterTileKey> keys = tileCache.tiles.keys();
+    for ( int i = 0; i < keys.size(); i++ )
+    {
+        if ( qwtTileRect( keys[i] ).intersects( rect ) )
+            tileCache.tiles.remove( keys[i] );
+    }
+
+#if QWT_ASYNC_RENDERING
+    if ( tileCache.pending
+        && qwtTileRect( tileCache.pendingKey ).intersects( rect ) )
+    {
+        d_data->cancelCacheTiles();
+    }
+#endif
+}
+
+/*!
+   \brief Set the maximum size of the tile cache
+
+   The least recently used tiles are dropped, when the size
+   of the cached tiles exceeds the limit. The default size is 64MB.
+
+   \param kiloBytes Maximum size in KB
+   \sa tileCacheSize(), TileCache
+*/
+void QwtPlotRasterItem::setTileCacheSize( int kiloBytes )
+{
+    d_data->tileCache.tiles.setMaxCost( qMax( kiloBytes, 0 ) );
+}
+
+/*!
+   \return Maximum size of the tile cache in KB
+   \sa setTileCacheSize(), TileCache
+*/
+int QwtPlotRasterItem::tileCacheSize() const
+{
+    return d_data->tileCache.tiles.maxCost();
+}
+
+/*!
+   \brief Check if images for the canvas are rendered in the background
+
+   The default implementation returns, if AsynchronousRendering
+   is enabled. Derived classes might reimplement it to render
+   synchronously, when they need to access the data from the
+   GUI thread while painting.
+
+   \return True, when images for the canvas are rendered
+           by a background thread
+   \sa AsynchronousRendering, QwtPlotSpectrogram::isAsynchronous()
+*/
+bool QwtPlotRasterItem::isAsynchronous() const
+{
+    return testPaintAttribute( AsynchronousRendering );
+}
+
+/*!
+   \brief Scheduler for rendering the tiles of an image
+
+   Implementations of renderImage() might use the scheduler to
+   distribute the pixels of an image over several threads. Its
+   thread pool, the size of the tiles and the statistics about
+   the last rendered image can be accessed here.
+
+   \return Tile scheduler of the item
+   \sa QwtPlotSpectrogram::renderImage(), renderThreadCount()
+*/
+QwtRasterTileScheduler *QwtPlotRasterItem::tileScheduler() const
+{
+    return &d_data->scheduler;
 }
 
 /*!
@@ -616,6 +1139,12 @@ void QwtPlotRasterItem::draw( QPainter *painter,
 
     const bool doCache = qwtUseCache( d_data->cache.policy, painter );
 
+    bool doAsync = false;
+#if QWT_ASYNC_RENDERING
+    if ( isAsynchronous() )
+        doAsync = qwtIsCanvasDevice( plot(), painter );
+#endif
+
     const QwtInterval xInterval = interval( Qt::XAxis );
     const QwtInterval yInterval = interval( Qt::YAxis );
 
@@ -677,7 +1206,7 @@ void QwtPlotRasterItem::draw( QPainter *painter,
         // data pixels we render in resolution of the paint device.
 
         image = compose(xxMap, yyMap, 
-            area, paintRect, paintRect.size().toSize(), doCache);
+            area, paintRect, paintRect.size().toSize(), doCache, doAsync);
         if ( image.isNull() )
             return;
 
@@ -721,7 +1250,7 @@ void QwtPlotRasterItem::draw( QPainter *painter,
         imageSize.setWidth( qRound( imageArea.width() / pixelRect.width() ) );
         imageSize.setHeight( qRound( imageArea.height() / pixelRect.height() ) );
         image = compose(xxMap, yyMap, 
-            imageArea, paintRect, imageSize, doCache );
+            imageArea, paintRect, imageSize, doCache, doAsync );
         if ( image.isNull() )
             return;
 
@@ -804,17 +1333,25 @@ QRectF QwtPlotRasterItem::boundingRect() const
 QImage QwtPlotRasterItem::compose( 
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
     const QRectF &imageArea, const QRectF &paintRect, 
-    const QSize &imageSize, bool doCache) const
+    const QSize &imageSize, bool doCache, bool doAsync ) const
 {
     QImage image;
     if ( imageArea.isEmpty() || paintRect.isEmpty() || imageSize.isEmpty() )
         return image;
 
-    if ( doCache )
+    // tiles are aligned to a grid in scale coordinates
+    const bool doTiles = doCache
+        && d_data->cache.policy == QwtPlotRasterItem::TileCache
+        && xMap.transformation() == NULL && yMap.transformation() == NULL;
+
+    const bool doPaintCache = doCache && !doTiles && !doAsync;
+
+    if ( doPaintCache )
     {
         if ( !d_data->cache.image.isNull()
             && d_data->cache.area == imageArea
-            && d_data->cache.size == paintRect.size() )
+            && d_data->cache.size == paintRect.size()
+            && d_data->cache.dirtyArea.isEmpty() )
         {
             image = d_data->cache.image;
         }
@@ -836,13 +1373,47 @@ QImage QwtPlotRasterItem::compose(
         const QwtScaleMap yyMap = 
             imageMap(Qt::Vertical, yMap, imageArea, imageSize, dy);
 
-        image = renderImage( xxMap, yyMap, imageArea, imageSize );
+#if QWT_ASYNC_RENDERING
+        if ( !doAsync )
+        {
+            // f.e. printing, while the canvas is rendered in the background
+            d_data->waitForJobs();
+        }
+#endif
+
+        if ( doTiles || doAsync )
+        {
+            if ( doTiles )
+            {
+                image = composeTiles( xxMap, yyMap,
+                    imageArea, imageSize, dx, dy, doAsync );
+            }
+            else
+            {
+                image = composeAsync( xxMap, yyMap, imageArea, imageSize );
+            }
 
-        if ( doCache )
+            if ( image.isNull() )
+                return image;
+        }
+        else
+        {
+            if ( doPaintCache )
+            {
+                image = scrollCache( xxMap, yyMap,
+                    imageArea, imageSize, dx, dy );
+            }
+
+            if ( image.isNull() )
+                image = renderImage( xxMap, yyMap, imageArea, imageSize );
+        }
+
+        if ( doPaintCache )
         {
             d_data->cache.area = imageArea;
             d_data->cache.size = paintRect.size();
             d_data->cache.image = image;
+            d_data->cache.dirtyArea = QRectF();
         }
     }
 
@@ -888,6 +1459,410 @@ QImage QwtPlotRasterItem::compose(
     return image;
 }
 
+/*
+  Render the image by a background thread and return what is
+  available so far: the last completed image, displayed for the
+  new scales, until the requested image has been completed.
+ */
+QImage QwtPlotRasterItem::composeAsync(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QRectF &imageArea, const QSize &imageSize ) const
+{
+#if QWT_ASYNC_RENDERING
+    PrivateData::AsyncRendering &async = d_data->async;
+
+    if ( async.area != imageArea || async.size != imageSize )
+    {
+        // tiles of the TileCache, for scales without a transformation
+        d_data->cancelCacheTiles();
+        d_data->cancelImage();
+
+        async.area = imageArea;
+        async.size = imageSize;
+
+        /*
+          One job for the complete image, so that the raster is
+          initialized once. renderImage() distributes the pixels
+          over the threads of the tileScheduler().
+         */
+        async.job = d_data->start( this, xMap, yMap, imageArea, imageSize );
+    }
+
+    if ( async.job && async.job->watcher.isFinished() )
+    {
+        async.image = async.job->watcher.result();
+
+        delete async.job;
+        async.job = NULL;
+
+        if ( !async.image.isNull() )
+        {
+            async.preview = async.image;
+            async.previewArea = imageArea;
+        }
+    }
+
+    if ( !async.image.isNull() )
+        return async.image;
+
+    QImage image( imageSize, QImage::Format_ARGB32 );
+    image.fill( 0 );
+
+    if ( !async.preview.isNull() )
+    {
+        // the last completed image, reprojected to the new scales
+        const QRectF previewRect =
+            QwtScaleMap::transform( xMap, yMap, async.previewArea );
+
+        QPainter painter( &image );
+        painter.drawImage( previewRect, async.preview );
+    }
+
+    return image;
+#else
+    Q_UNUSED( xMap );
+    Q_UNUSED( yMap );
+    Q_UNUSED( imageArea );
+    Q_UNUSED( imageSize );
+
+    return QImage();
+#endif
+}
+
+/*
+  Reuse the cached image, when the scales have been scrolled by
+  a number of whole pixels. Only the pixels, that are newly exposed
+  or have been invalidated by invalidateCacheArea(), are rendered.
+ */
+QImage QwtPlotRasterItem::scrollCache(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QRectF &imageArea, const QSize &imageSize,
+    double dx, double dy ) const
+{
+    const PrivateData::ImageCache &cache = d_data->cache;
+
+    if ( cache.image.isNull() || cache.image.size() != imageSize )
+        return QImage();
+
+    if ( cache.image.format() != QImage::Format_Indexed8 &&
+        cache.image.format() != QImage::Format_ARGB32 )
+    {
+        return QImage();
+    }
+
+    // scrolling by whole pixels needs linear maps of the same scale
+
+    if ( xMap.transformation() || yMap.transformation() )
+        return QImage();
+
+    const QRectF r0 = QwtScaleMap::transform(
+        xMap, yMap, imageArea ).normalized();
+    const QRectF r1 = QwtScaleMap::transform(
+        xMap, yMap, cache.area ).normalized();
+
+    const double eps = 1e-3;
+
+    if ( qAbs( r1.width() - r0.width() ) > eps ||
+        qAbs( r1.height() - r0.height() ) > eps )
+    {
+        return QImage();
+    }
+
+    const int x0 = qRound( r1.left() - r0.left() );
+    const int y0 = qRound( r1.top() - r0.top() );
+
+    if ( qAbs( r1.left() - r0.left() - x0 ) > eps ||
+        qAbs( r1.top() - r0.top() - y0 ) > eps )
+    {
+        return QImage();
+    }
+
+    const int w = imageSize.width();
+    const int h = imageSize.height();
+
+    if ( qAbs( x0 ) >= w || qAbs( y0 ) >= h )
+        return QImage();
+
+    QImage image( imageSize, cache.image.format() );
+    if ( image.format() == QImage::Format_Indexed8 )
+        image.setColorTable( cache.image.colorTable() );
+
+    // the pixels, that are still visible
+
+    const QRect copied( QPoint( qMax( x0, 0 ), qMax( y0, 0 ) ),
+        QPoint( qMin( w, w + x0 ) - 1, qMin( h, h + y0 ) - 1 ) );
+
+    qwtCopyPixels( cache.image, image,
+        copied.topLeft() - QPoint( x0, y0 ), copied );
+
+    // the pixels, that need to be rendered
+
+    QList<QRect> rects;
+
+    if ( copied.top() > 0 )
+        rects += QRect( 0, 0, w, copied.top() );
+
+    if ( copied.bottom() < h - 1 )
+        rects += QRect( 0, copied.bottom() + 1, w, h - 1 - copied.bottom() );
+
+    if ( copied.left() > 0 )
+        rects += QRect( 0, copied.top(), copied.left(), copied.height() );
+
+    if ( copied.right() < w - 1 )
+    {
+        rects += QRect( copied.right() + 1, copied.top(),
+            w - 1 - copied.right(), copied.height() );
+    }
+
+    if ( !cache.dirtyArea.isEmpty() )
+    {
+        const QRectF r = QwtScaleMap::transform(
+            xMap, yMap, cache.dirtyArea ).normalized();
+
+        // a margin for the offsets of the image maps
+        const QRect dirtyRect(
+            QPoint( qFloor( r.left() ) - 1, qFloor( r.top() ) - 1 ),
+            QPoint( qCeil( r.right() ) + 1, qCeil( r.bottom() ) + 1 ) );
+
+        const QRect rect = dirtyRect & image.rect();
+        if ( !rect.isEmpty() )
+            rects += rect;
+    }
+
+    for ( int i = 0; i < rects.size(); i++ )
+    {
+        const QRect &rect = rects[i];
+
+        const QRectF area = qwtTileArea( xMap, yMap, rect, dx, dy );
+
+        const QwtScaleMap xxMap =
+            imageMap( Qt::Horizontal, xMap, area, rect.size(), dx );
+        const QwtScaleMap yyMap =
+            imageMap( Qt::Vertical, yMap, area, rect.size(), dy );
+
+        const QImage tile = renderImage( xxMap, yyMap, area, rect.size() );
+
+        if ( tile.size() != rect.size() || tile.format() != image.format()
+            || tile.colorTable() != image.colorTable() )
+        {
+            return QImage();
+        }
+
+        qwtCopyPixels( tile, image, QPoint( 0, 0 ), rect );
+    }
+
+    return image;
+}
+
+/*
+  Compose the image from tiles of the TileCache. Missing tiles are
+  rendered - one after the other by a background thread for doAsync.
+ */
+QImage QwtPlotRasterItem::composeTiles(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QRectF &imageArea, const QSize &imageSize,
+    double dx, double dy, bool doAsync ) const
+{
+    PrivateData::TileCache &cache = d_data->tileCache;
+
+#if QWT_ASYNC_RENDERING
+    // images of composeAsync(), for scales with a transformation
+    if ( d_data->async.job )
+        d_data->cancelImage();
+#endif
+
+    if ( xMap.pDist() <= 0.0 || yMap.pDist() <= 0.0 )
+    {
+        d_data->cancelCacheTiles();
+#if QWT_ASYNC_RENDERING
+        d_data->waitForJobs();
+#endif
+        return renderImage( xMap, yMap, imageArea, imageSize );
+    }
+
+    /*
+      When rendering in resolution of the data pixels the tiles
+      are aligned to them. Otherwise the resolution is rounded
+      to discrete zoom levels.
+     */
+
+    double pw = dx;
+    if ( pw <= 0.0 )
+        pw = qwtZoomLevelSize( xMap.sDist() / xMap.pDist() );
+
+    double ph = dy;
+    if ( ph <= 0.0 )
+        ph = qwtZoomLevelSize( yMap.sDist() / yMap.pDist() );
+
+    const double x0 = ( dx > 0.0 ) ? ::fmod( imageArea.left(), pw ) : 0.0;
+    const double y0 = ( dy > 0.0 ) ? ::fmod( imageArea.top(), ph ) : 0.0;
+
+    const double tw = qwtTileSize * pw;
+    const double th = qwtTileSize * ph;
+
+    const int col1 = qFloor( ( imageArea.left() - x0 ) / tw );
+    const int col2 = qFloor( ( imageArea.right() - x0 ) / tw );
+    const int row1 = qFloor( ( imageArea.top() - y0 ) / th );
+    const int row2 = qFloor( ( imageArea.bottom() - y0 ) / th );
+
+    const int numTiles = ( col2 - col1 + 1 ) * ( row2 - row1 + 1 );
+    if ( numTiles > 1024 )
+    {
+        d_data->cancelCacheTiles();
+#if QWT_ASYNC_RENDERING
+        d_data->waitForJobs();
+#endif
+        return renderImage( xMap, yMap, imageArea, imageSize );
+    }
+
+    // the tiles of this image, in case they don't fit into the cache
+    QHash<QwtRasterTileKey, QImage> tiles;
+
+#if QWT_ASYNC_RENDERING
+    if ( cache.pending )
+    {
+        const QwtRasterTileKey &key = cache.pendingKey;
+
+        const bool isVisible = key.pixelWidth == pw && key.pixelHeight == ph
+            && key.col >= col1 && key.col <= col2
+            && key.row >= row1 && key.row <= row2;
+
+        if ( cache.pending->watcher.isFinished() )
+        {
+            const QImage tile = cache.pending->watcher.result();
+            cache.tiles.insert( key, new QImage( tile ),
+                qMax( tile.byteCount() / 1024, 1 ) );
+
+            if ( isVisible )
+                tiles.insert( key, tile );
+
+            delete cache.pending;
+            cache.pending = NULL;
+        }
+        else if ( !isVisible )
+        {
+            // a different zoom level or scrolled out
+            d_data->cancelCacheTiles();
+        }
+    }
+#endif
+
+    int numAvailable = 0;
+
+    QList<QwtRasterTileKey> missingTiles;
+
+    for ( int row = row1; row <= row2; row++ )
+    {
+        for ( int col = col1; col <= col2; col++ )
+        {
+            const QwtRasterTileKey key( pw, ph, col, row );
+
+            if ( tiles.contains( key ) )
+            {
+                numAvailable++;
+                continue;
+            }
+
+            const QImage *tile = cache.tiles.object( key );
+            if ( tile )
+            {
+                tiles.insert( key, *tile );
+                numAvailable++;
+            }
+#if QWT_ASYNC_RENDERING
+            else if ( !( cache.pending && cache.pendingKey == key ) )
+#else
+            else
+#endif
+            {
+                missingTiles += key;
+            }
+        }
+    }
+
+    const QSize tileSize( qwtTileSize, qwtTileSize );
+
+    for ( int i = 0; i < missingTiles.size(); i++ )
+    {
+        const QwtRasterTileKey &key = missingTiles[i];
+        const QRectF area( x0 + key.col * tw, y0 + key.row * th, tw, th );
+
+        const QwtScaleMap xxMap =
+            imageMap( Qt::Horizontal, xMap, area, tileSize, pw );
+        const QwtScaleMap yyMap =
+            imageMap( Qt::Vertical, yMap, area, tileSize, ph );
+
+#if QWT_ASYNC_RENDERING
+        if ( doAsync )
+        {
+            /*
+              The tiles are rendered one after the other, so that
+              the raster data is never initialized concurrently.
+              renderImage() distributes the pixels of a tile
+              over the threads of the tileScheduler().
+             */
+            if ( cache.pending == NULL )
+            {
+                cache.pendingKey = key;
+                cache.pending =
+                    d_data->start( this, xxMap, yyMap, area, tileSize );
+            }
+
+            break;
+        }
+#else
+        Q_UNUSED( doAsync );
+#endif
+
+        const QImage tile = renderImage( xxMap, yyMap, area, tileSize );
+        cache.tiles.insert( key, new QImage( tile ),
+            qMax( tile.byteCount() / 1024, 1 ) );
+
+        tiles.insert( key, tile );
+        numAvailable++;
+    }
+
+    QImage image( imageSize, QImage::Format_ARGB32 );
+    image.fill( 0 );
+
+    QPainter painter( &image );
+    if ( dx <= 0.0 || dy <= 0.0 )
+        painter.setRenderHint( QPainter::SmoothPixmapTransform, true );
+
+    const bool isComplete = ( numAvailable == numTiles );
+
+    if ( !isComplete && !d_data->async.preview.isNull() )
+    {
+        const QRectF previewRect =
+            QwtScaleMap::transform( xMap, yMap, d_data->async.previewArea );
+
+        painter.drawImage( previewRect, d_data->async.preview );
+    }
+
+    for ( QHash<QwtRasterTileKey, QImage>::const_iterator it = tiles.constBegin();
+        it != tiles.constEnd(); ++it )
+    {
+        const QwtRasterTileKey &key = it.key();
+        const QRectF area( x0 + key.col * tw, y0 + key.row * th, tw, th );
+
+        // the image maps have the centers of the pixels at integers
+        QRectF rect = QwtScaleMap::transform( xMap, yMap, area ).normalized();
+        rect.translate( 0.5, 0.5 );
+
+        painter.drawImage( rect, it.value() );
+    }
+
+    painter.end();
+
+    if ( isComplete )
+    {
+        d_data->async.preview = image;
+        d_data->async.previewArea = imageArea;
+    }
+
+    return image;
+}
+
 /*!
    \brief Calculate a scale map for painting to an image
 
@@ -17,6 +17,8 @@
 #include <qstring.h>
 #include <qimage.h>
 
+class QwtRasterTileScheduler;
+
 /*!
   \brief A class, which displays raster data
 
@@ -55,8 +57,35 @@ public:
           This type of cache is useful for improving the performance 
           of hide/show operations or manipulations of the alpha value. 
           All other situations are handled by the canvas backing store.
+
+          When the scales have been scrolled by a number of whole pixels
+          of the image ( f.e. a waterfall display, where the scale
+          follows the data ), the cached image is shifted and only the
+          pixels, that are newly exposed, are rendered. Areas, that
+          have been invalidated by invalidateCacheArea(), are rendered
+          again.
          */
-        PaintCache
+        PaintCache,
+
+        /*!
+          The image is composed from tiles of 256x256 pixels, that are
+          aligned to a grid in scale coordinates. The tiles are stored
+          in a cache of limited size ( see setTileCacheSize() ),
+          where the least recently used tiles are dropped.
+
+          When panning, only the tiles, that are newly exposed, need
+          to be rendered. Tiles are rendered for discrete zoom levels
+          in steps of 2^(1/8) and scaled to the resolution of the
+          canvas, so that zooming back to a level, that has been
+          visited before, finds its tiles in the cache.
+
+          With AsynchronousRendering the missing tiles are rendered
+          one after the other by a background thread.
+
+          For scales with a transformation ( f.e. logarithmic scales )
+          the item falls back to PaintCache.
+         */
+        TileCache
     };
 
     /*!
@@ -77,7 +106,33 @@ public:
           depends on the implementation of the specific QPaintEngine.
          */
 
-        PaintInDeviceResolution = 1
+        PaintInDeviceResolution = 1,
+
+        /*!
+          When painting to the canvas, the image is rendered by
+          a background thread, instead of blocking the GUI thread.
+          Until it is available, the last rendered image is displayed
+          for the new scales ( or a preview in low resolution ).
+          The plot is replotted, when the image has been completed.
+
+          Only one image is rendered at a time. Rendering an image
+          for outdated scales is cancelled without blocking the
+          GUI thread: its result is dropped and the next image is
+          started, when it has returned. Implementations of
+          renderImage(), that render their pixels by the
+          tileScheduler(), can be cancelled quickly.
+
+          \note renderImage() is called from a background thread.
+                Derived classes have to call invalidateCache(), that
+                waits for the background thread, before modifying
+                or deleting data, that is needed for rendering.
+                This is mandatory for their destructor, where the
+                background thread would run on a deleted
+                object otherwise.
+
+          \sa isAsynchronous()
+         */
+        AsynchronousRendering = 2
     };
 
     //! Paint attributes
@@ -96,7 +151,13 @@ public:
     void setCachePolicy( CachePolicy );
     CachePolicy cachePolicy() const;
 
-    void invalidateCache();
+    virtual void invalidateCache();
+    virtual void invalidateCacheArea( const QRectF & );
+
+    void setTileCacheSize( int kiloBytes );
+    int tileCacheSize() const;
+
+    QwtRasterTileScheduler *tileScheduler() const;
 
     virtual void draw( QPainter *p,
         const QwtScaleMap &xMap, const QwtScaleMap &yMap,
@@ -132,6 +193,8 @@ protected:
         const QwtScaleMap &map, const QRectF &area,
         const QSize &imageSize, double pixelSize) const;
 
+    virtual bool isAsynchronous() const;
+
 private:
     QwtPlotRasterItem( const QwtPlotRasterItem & );
     QwtPlotRasterItem &operator=( const QwtPlotRasterItem & );
@@ -140,8 +203,18 @@ private:
 
     QImage compose( const QwtScaleMap &, const QwtScaleMap &,
         const QRectF &imageArea, const QRectF &paintRect,
-        const QSize &imageSize, bool doCache) const;
+        const QSize &imageSize, bool doCache, bool doAsync ) const;
+
+    QImage composeAsync( const QwtScaleMap &, const QwtScaleMap &,
+        const QRectF &imageArea, const QSize &imageSize ) const;
+
+    QImage composeTiles( const QwtScaleMap &, const QwtScaleMap &,
+        const QRectF &imageArea, const QSize &imageSize,
+        double dx, double dy, bool doAsync ) const;
 
+    QImage scrollCache( const QwtScaleMap &, const QwtScaleMap &,
+        const QRectF &imageArea, const QSize &imageSize,
+        double dx, double dy ) const;
 
     class PrivateData;
     PrivateData *d_data;
@@ -11,7 +11,56 @@
 #include "qwt_color_map.h"
 #include "qwt_scale_map.h"
 #include "qwt_painter.h"
+#include "qwt_symbol.h"
 #include <qpainter.h>
+#include <qhash.h>
+#include <qmap.h>
+#include <qnumeric.h>
+
+// number of colors, the color range is divided into for the symbols
+static const int qwtNumColorLevels = 256;
+
+/*
+  SVG documents can't be read back from a symbol and the rendering
+  of user styles is implemented in derived classes. So these symbols
+  can't be copied for the buckets.
+ */
+static inline bool qwtIsCopyable( const QwtSymbol *symbol )
+{
+    return symbol->style() != QwtSymbol::SvgDocument
+        && symbol->style() < QwtSymbol::UserStyle;
+}
+
+// copy of a symbol with a different color and size
+static QwtSymbol *qwtBucketSymbol( const QwtSymbol *symbol,
+    const QColor *color, const QSize &size )
+{
+    QwtSymbol *s = new QwtSymbol( symbol->style(),
+        symbol->brush(), symbol->pen(), size );
+
+    switch( symbol->style() )
+    {
+        case QwtSymbol::Path:
+            s->setPath( symbol->path() );
+            break;
+        case QwtSymbol::Pixmap:
+            s->setPixmap( symbol->pixmap() );
+            break;
+        case QwtSymbol::Graphic:
+            s->setGraphic( symbol->graphic() );
+            break;
+        default:
+            break;
+    }
+
+    s->setPinPoint( symbol->pinPoint(), symbol->isPinPointEnabled() );
+    s->setCachePolicy( symbol->cachePolicy() );
+
+    if ( color )
+        s->setColor( *color );
+
+    return s;
+}
 
 class QwtPlotSpectroCurve::PrivateData
 {
@@ -19,21 +68,57 @@ public:
     PrivateData():
         colorRange( 0.0, 1000.0 ),
         penWidth(0.0),
-        paintAttributes( QwtPlotSpectroCurve::ClipPoints )
+        paintAttributes( QwtPlotSpectroCurve::ClipPoints ),
+        symbol( NULL ),
+        symbolAttributes( QwtPlotSpectroCurve::ColorByValue )
     {
         colorMap = new QwtLinearColorMap();
     }
 
     ~PrivateData()
     {
+        clearSymbolAtlas();
+
+        delete symbol;
         delete colorMap;
     }
 
+    void clearSymbolAtlas()
+    {
+        qDeleteAll( symbolAtlas );
+        symbolAtlas.clear();
+    }
+
+    bool hasSymbolSizeRange() const
+    {
+        return ( symbolAttributes & QwtPlotSpectroCurve::SizeByValue )
+            && minSymbolSize.isValid() && maxSymbolSize.isValid();
+    }
+
+    int numSizeLevels() const
+    {
+        if ( !hasSymbolSizeRange() )
+            return 1;
+
+        const int dw = qAbs( maxSymbolSize.width() - minSymbolSize.width() );
+        const int dh = qAbs( maxSymbolSize.height() - minSymbolSize.height() );
+
+        return qMin( qMax( dw, dh ) + 1, 256 );
+    }
+
     QwtColorMap *colorMap;
     QwtInterval colorRange;
     QVector<QRgb> colorTable;
     double penWidth;
     QwtPlotSpectroCurve::PaintAttributes paintAttributes;
+
+    QwtSymbol *symbol;
+    QwtPlotSpectroCurve::SymbolAttributes symbolAttributes;
+    QSize minSymbolSize;
+    QSize maxSymbolSize;
+
+    // copies of the symbol for each combination of color and size
+    QHash<int, QwtSymbol *> symbolAtlas;
 };
 
 /*!
@@ -150,6 +235,8 @@ void QwtPlotSpectroCurve::setColorMap( QwtColorMap *colorMap )
         d_data->colorMap = colorMap;
     }
 
+    d_data->clearSymbolAtlas();
+
     legendChanged();
     itemChanged();
 }
@@ -176,6 +263,7 @@ void QwtPlotSpectroCurve::setColorRange( const QwtInterval &interval )
     if ( interval != d_data->colorRange )
     {
         d_data->colorRange = interval;
+        d_data->clearSymbolAtlas();
 
         legendChanged();
         itemChanged();
@@ -220,6 +308,138 @@ double QwtPlotSpectroCurve::penWidth() const
     return d_data->penWidth;
 }
 
+/*!
+  \brief Assign a symbol
+
+  When a symbol is set, the points are displayed as symbols
+  instead of dots. The color and/or the size of the symbol are
+  modified according to the symbol attributes.
+
+  \param symbol Symbol
+  \sa symbol(), setSymbolAttribute(), drawSymbols()
+
+  \note Symbols of the QwtSymbol::SvgDocument style or user styles
+        can't be copied for the colors and sizes. For those symbols
+        the points are displayed by drawDots().
+*/
+void QwtPlotSpectroCurve::setSymbol( QwtSymbol *symbol )
+{
+    if ( symbol != d_data->symbol )
+    {
+        delete d_data->symbol;
+        d_data->symbol = symbol;
+
+        d_data->clearSymbolAtlas();
+
+        legendChanged();
+        itemChanged();
+    }
+}
+
+/*!
+  \return Current symbol or NULL, when no symbol has been assigned
+  \sa setSymbol()
+*/
+const QwtSymbol *QwtPlotSpectroCurve::symbol() const
+{
+    return d_data->symbol;
+}
+
+/*!
+  Specify an attribute how to map the z coordinate to the symbol
+
+  The default setting is ColorByValue.
+
+  \param attribute Symbol attribute
+  \param on On/Off
+  \sa SymbolAttribute, testSymbolAttribute(), setSymbolSizeRange()
+*/
+void QwtPlotSpectroCurve::setSymbolAttribute(
+    SymbolAttribute attribute, bool on )
+{
+    if ( bool( d_data->symbolAttributes & attribute ) == on )
+        return;
+
+    if ( on )
+        d_data->symbolAttributes |= attribute;
+    else
+        d_data->symbolAttributes &= ~attribute;
+
+    d_data->clearSymbolAtlas();
+
+    legendChanged();
+    itemChanged();
+}
+
+/*!
+    \return True, when attribute is enabled
+    \sa SymbolAttribute, setSymbolAttribute()
+*/
+bool QwtPlotSpectroCurve::testSymbolAttribute(
+    SymbolAttribute attribute ) const
+{
+    return ( d_data->symbolAttributes & attribute );
+}
+
+/*!
+  \brief Set the range of the symbol sizes
+
+  When SizeByValue is enabled, colorRange().minValue() is mapped
+  to minSize and colorRange().maxValue() to maxSize. The sizes
+  in between are interpolated in steps of one pixel. As long as
+  one of the sizes is invalid, the size of the symbol is used.
+
+  The sizes are normalized, so that minSymbolSize() is never
+  larger than maxSymbolSize().
+
+  \param minSize Size of the symbol for the minimum of the color range
+  \param maxSize Size of the symbol for the maximum of the color range
+
+  \sa minSymbolSize(), maxSymbolSize(), SizeByValue
+*/
+void QwtPlotSpectroCurve::setSymbolSizeRange(
+    const QSize &minSize, const QSize &maxSize )
+{
+    QSize size1 = minSize;
+    QSize size2 = maxSize;
+
+    if ( size1.isValid() && size2.isValid() )
+    {
+        size1 = minSize.boundedTo( maxSize );
+        size2 = minSize.expandedTo( maxSize );
+    }
+
+    if ( size1 != d_data->minSymbolSize ||
+        size2 != d_data->maxSymbolSize )
+    {
+        d_data->minSymbolSize = size1;
+        d_data->maxSymbolSize = size2;
+
+        d_data->clearSymbolAtlas();
+
+        legendChanged();
+        itemChanged();
+    }
+}
+
+/*!
+  \return Size of the symbol for the minimum of the color range
+  \sa setSymbolSizeRange()
+*/
+QSize QwtPlotSpectroCurve::minSymbolSize() const
+{
+    return d_data->minSymbolSize;
+}
+
+/*!
+  \return Size of the symbol for the maximum of the color range
+  \sa setSymbolSizeRange()
+*/
+QSize QwtPlotSpectroCurve::maxSymbolSize() const
+{
+    return d_data->maxSymbolSize;
+}
+
 /*!
   Draw a subset of the points
 
@@ -231,7 +451,7 @@ double QwtPlotSpectroCurve::penWidth() const
   \param to Index of the last sample to be painted. If to < 0 the
          series will be painted to its last sample.
 
-  \sa drawDots()
+  \sa drawDots(), drawSymbols()
 */
 void QwtPlotSpectroCurve::drawSeries( QPainter *painter,
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
@@ -249,7 +469,16 @@ void QwtPlotSpectroCurve::drawSeries( QPainter *painter,
     if ( from > to )
         return;
 
-    drawDots( painter, xMap, yMap, canvasRect, from, to );
+    if ( d_data->symbol &&
+        d_data->symbol->style() != QwtSymbol::NoSymbol &&
+        qwtIsCopyable( d_data->symbol ) )
+    {
+        drawSymbols( painter, xMap, yMap, canvasRect, from, to );
+    }
+    else
+    {
+        drawDots( painter, xMap, yMap, canvasRect, from, to );
+    }
 }
 
 /*!
@@ -280,42 +509,214 @@ void QwtPlotSpectroCurve::drawDots( QPainter *painter,
 
     const QwtSeriesData<QwtPoint3D> *series = data();
 
-    for ( int i = from; i <= to; i++ )
+    // the colors are mapped in chunks to avoid a virtual call per sample
+    const int chunkSize = 256;
+
+    QwtPoint3D samples[chunkSize];
+    double z[chunkSize];
+    QRgb rgbs[chunkSize];
+    unsigned char indexes[chunkSize];
+
+    for ( int i0 = from; i0 <= to; i0 += chunkSize )
     {
-        const QwtPoint3D sample = series->sample( i );
+        const int n = qMin( chunkSize, to - i0 + 1 );
+
+        series->copySamples( i0, n, samples );
+
+        for ( int j = 0; j < n; j++ )
+            z[j] = samples[j].z();
 
-        double xi = xMap.transform( sample.x() );
-        double yi = yMap.transform( sample.y() );
-        if ( doAlign )
+        if ( format == QwtColorMap::RGB )
         {
-            xi = qRound( xi );
-            yi = qRound( yi );
+            d_data->colorMap->rgbValues( d_data->colorRange, z, n, rgbs );
+        }
+        else
+        {
+            d_data->colorMap->colorIndexes( d_data->colorRange, z, n, indexes );
+            for ( int j = 0; j < n; j++ )
+                rgbs[j] = d_data->colorTable[ indexes[j] ];
         }
 
-        if ( d_data->paintAttributes & QwtPlotSpectroCurve::ClipPoints )
+        for ( int j = 0; j < n; j++ )
         {
-            if ( !canvasRect.contains( xi, yi ) )
-                continue;
+            const QwtPoint3D &sample = samples[j];
+
+            double xi = xMap.transform( sample.x() );
+            double yi = yMap.transform( sample.y() );
+            if ( doAlign )
+            {
+                xi = qRound( xi );
+                yi = qRound( yi );
+            }
+
+            if ( d_data->paintAttributes & QwtPlotSpectroCurve::ClipPoints )
+            {
+                if ( !canvasRect.contains( xi, yi ) )
+                    continue;
+            }
+
+            painter->setPen( QPen( QColor::fromRgba( rgbs[j] ),
+                d_data->penWidth ) );
+
+            QwtPainter::drawPoint( painter, QPointF( xi, yi ) );
         }
+    }
 
-        if ( format == QwtColorMap::RGB )
+    d_data->colorTable.clear();
+}
+
+/*!
+  Draw a subset of the points as symbols
+
+  The z coordinates are quantized into 256 colors and - for SizeByValue -
+  into sizes in steps of one pixel. The points are sorted into buckets
+  of the same color and size, that are painted with one copy of
+  the symbol each. Larger symbols are painted below smaller ones.
+
+  \param painter Painter
+  \param xMap Maps x-values into pixel coordinates.
+  \param yMap Maps y-values into pixel coordinates.
+  \param canvasRect Contents rectangle of the canvas
+  \param from Index of the first sample to be painted
+  \param to Index of the last sample to be painted. If to < 0 the
+         series will be painted to its last sample.
+
+  \sa drawSeries(), setSymbol()
+*/
+void QwtPlotSpectroCurve::drawSymbols( QPainter *painter,
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QRectF &canvasRect, int from, int to ) const
+{
+    const QwtInterval &range = d_data->colorRange;
+    if ( d_data->symbol == NULL || !range.isValid() )
+        return;
+
+    const bool colorByValue =
+        d_data->symbolAttributes & QwtPlotSpectroCurve::ColorByValue;
+
+    const int numColorLevels = colorByValue ? qwtNumColorLevels : 1;
+    const int numSizeLevels = d_data->numSizeLevels();
+
+    const bool doAlign = QwtPainter::roundingAlignment( painter );
+
+    const double width = range.width();
+    const QwtSeriesData<QwtPoint3D> *series = data();
+
+    // larger symbols have lower keys and are painted first
+    QMap<int, QPolygonF> buckets;
+
+    int lastKey = -1;
+    QPolygonF *bucket = NULL;
+
+    const int chunkSize = 256;
+    QwtPoint3D samples[chunkSize];
+
+    for ( int i0 = from; i0 <= to; i0 += chunkSize )
+    {
+        const int n = qMin( chunkSize, to - i0 + 1 );
+
+        series->copySamples( i0, n, samples );
+
+        for ( int j = 0; j < n; j++ )
         {
-            const QRgb rgb = d_data->colorMap->rgb(
-                d_data->colorRange, sample.z() );
+            const QwtPoint3D &sample = samples[j];
 
-            painter->setPen( QPen( QColor::fromRgba( rgb ), d_data->penWidth ) );
+            if ( qIsNaN( sample.z() ) )
+                continue;
+
+            double xi = xMap.transform( sample.x() );
+            double yi = yMap.transform( sample.y() );
+            if ( doAlign )
+            {
+                xi = qRound( xi );
+                yi = qRound( yi );
+            }
+
+            if ( d_data->paintAttributes & QwtPlotSpectroCurve::ClipPoints )
+            {
+                if ( !canvasRect.contains( xi, yi ) )
+                    continue;
+            }
+
+            double ratio = 0.0;
+            if ( width > 0.0 )
+                ratio = ( sample.z() - range.minValue() ) / width;
+
+            ratio = qBound( 0.0, ratio, 1.0 );
+
+            const int colorLevel = qRound( ratio * ( numColorLevels - 1 ) );
+            const int sizeLevel = qRound( ratio * ( numSizeLevels - 1 ) );
+
+            const int key = ( numSizeLevels - 1 - sizeLevel ) * numColorLevels
+                + colorLevel;
+
+            // neighboured points often end up in the same bucket
+            if ( key != lastKey )
+            {
+                bucket = &buckets[ key ];
+                lastKey = key;
+            }
+
+            *bucket += QPointF( xi, yi );
         }
-        else
+    }
+
+    for ( QMap<int, QPolygonF>::const_iterator it = buckets.constBegin();
+        it != buckets.constEnd(); ++it )
+    {
+        const int colorLevel = it.key() % numColorLevels;
+        const int sizeLevel = numSizeLevels - 1 - it.key() / numColorLevels;
+
+        const QwtSymbol *symbol = bucketSymbol( colorLevel, sizeLevel );
+        symbol->drawSymbols( painter, it.value() );
+    }
+}
+
+// the copy of the symbol for a bucket, created on demand
+const QwtSymbol *QwtPlotSpectroCurve::bucketSymbol(
+    int colorLevel, int sizeLevel ) const
+{
+    const int key = sizeLevel * qwtNumColorLevels + colorLevel;
+
+    QwtSymbol *&symbol = d_data->symbolAtlas[ key ];
+    if ( symbol == NULL )
+    {
+        const QwtInterval &range = d_data->colorRange;
+
+        QSize size = d_data->symbol->size();
+
+        if ( d_data->hasSymbolSizeRange() )
         {
-            const unsigned char index = d_data->colorMap->colorIndex(
-                d_data->colorRange, sample.z() );
+            const int numSizeLevels = d_data->numSizeLevels();
 
-            painter->setPen( QPen( QColor::fromRgba( d_data->colorTable[index] ), 
-                d_data->penWidth ) );
+            double ratio = 0.0;
+            if ( numSizeLevels > 1 )
+                ratio = double( sizeLevel ) / ( numSizeLevels - 1 );
+
+            const QSize &s1 = d_data->minSymbolSize;
+            const QSize &s2 = d_data->maxSymbolSize;
+
+            size.setWidth( s1.width()
+                + qRound( ratio * ( s2.width() - s1.width() ) ) );
+            size.setHeight( s1.height()
+                + qRound( ratio * ( s2.height() - s1.height() ) ) );
         }
 
-        QwtPainter::drawPoint( painter, QPointF( xi, yi ) );
+        if ( d_data->symbolAttributes & QwtPlotSpectroCurve::ColorByValue )
+        {
+            const double value = range.minValue()
+                + colorLevel * range.width() / ( qwtNumColorLevels - 1 );
+
+            const QColor color = QColor::fromRgba(
+                d_data->colorMap->rgb( range, value ) );
+
+            symbol = qwtBucketSymbol( d_data->symbol, &color, size );
+        }
+        else
+        {
+            symbol = qwtBucketSymbol( d_data->symbol, NULL, size );
+        }
     }
 
-    d_data->colorTable.clear();
+    return symbol;
 }
@@ -20,6 +20,20 @@ class QwtColorMap;
 /*!
     \brief Curve that displays 3D points as dots, where the z coordinate is
            mapped to a color.
+
+    When a symbol has been assigned, the points are displayed as symbols
+    instead of dots. Depending on the SymbolAttributes the z coordinate
+    is mapped to the color and/or the size of the symbol.
+
+    For rendering the symbols the points are sorted into buckets of the
+    same color and size. For each bucket a copy of the symbol is created
+    once and all of its points are painted in one call of
+    QwtSymbol::drawSymbols(), what usually ends in blitting its cached
+    pixmap.
+
+    Symbols, that can't be copied - QwtSymbol::SvgDocument and user
+    styles - are not supported. For those the points are displayed
+    as dots.
 */
 class QWT_EXPORT QwtPlotSpectroCurve: 
     public QwtPlotSeriesItem, QwtSeriesStore<QwtPoint3D>
@@ -35,6 +49,25 @@ public:
     //! Paint attributes
     typedef QFlags<PaintAttribute> PaintAttributes;
 
+    /*!
+      \brief Attributes, how to map the z coordinate to a symbol
+      \sa setSymbolAttribute(), setSymbol()
+     */
+    enum SymbolAttribute
+    {
+        //! Map the z coordinate to the color of the symbol
+        ColorByValue = 0x01,
+
+        /*!
+          Map the z coordinate to the size of the symbol
+          \sa setSymbolSizeRange()
+         */
+        SizeByValue = 0x02
+    };
+
+    //! Symbol attributes
+    typedef QFlags<SymbolAttribute> SymbolAttributes;
+
     explicit QwtPlotSpectroCurve( const QString &title = QString::null );
     explicit QwtPlotSpectroCurve( const QwtText &title );
 
@@ -62,18 +95,34 @@ public:
     void setPenWidth(double width);
     double penWidth() const;
 
+    void setSymbol( QwtSymbol * );
+    const QwtSymbol *symbol() const;
+
+    void setSymbolAttribute( SymbolAttribute, bool on = true );
+    bool testSymbolAttribute( SymbolAttribute ) const;
+
+    void setSymbolSizeRange( const QSize &minSize, const QSize &maxSize );
+    QSize minSymbolSize() const;
+    QSize maxSymbolSize() const;
+
 protected:
     virtual void drawDots( QPainter *,
         const QwtScaleMap &xMap, const QwtScaleMap &yMap,
         const QRectF &canvasRect, int from, int to ) const;
 
+    virtual void drawSymbols( QPainter *,
+        const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QRectF &canvasRect, int from, int to ) const;
+
 private:
     void init();
+    const QwtSymbol *bucketSymbol( int colorLevel, int sizeLevel ) const;
 
     class PrivateData;
     PrivateData *d_data;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS( QwtPlotSpectroCurve::PaintAttributes )
+Q_DECLARE_OPERATORS_FOR_FLAGS( QwtPlotSpectroCurve::SymbolAttributes )
 
 #endif
@@ -12,22 +12,51 @@
 #include "qwt_interval.h"
 #include "qwt_scale_map.h"
 #include "qwt_color_map.h"
+#include "qwt_raster_tile_scheduler.h"
 #include <qimage.h>
 #include <qpen.h>
 #include <qpainter.h>
 #include <qmath.h>
 #include <qalgorithms.h>
-#if QT_VERSION >= 0x040400
-#include <qthread.h>
-#include <qfuture.h>
-#include <qtconcurrentrun.h>
-#endif
+#include <qvector.h>
+
+static inline bool qwtIsSimilarResolution( double resolution1,
+    double resolution2 )
+{
+    const double ratio = resolution1 / resolution2;
+    return ratio > 0.7 && ratio < 1.42; // sqrt(2)
+}
+
+// renders the tiles of an image from the tables of the pixel coordinates
+class QwtPlotSpectrogram::TileRenderer: public QwtRasterTileScheduler::Task
+{
+public:
+    TileRenderer( const QwtPlotSpectrogram *spectrogram,
+            const QwtRasterData::RasterCoordinates *raster, QImage *image ):
+        d_spectrogram( spectrogram ),
+        d_raster( raster ),
+        d_image( image )
+    {
+    }
+
+    virtual void renderTile( const QRect &tile )
+    {
+        d_spectrogram->renderTileRows(
+            d_raster, tile.topLeft(), tile, d_image );
+    }
+
+private:
+    const QwtPlotSpectrogram *d_spectrogram;
+    const QwtRasterData::RasterCoordinates *d_raster;
+    QImage *d_image;
+};
 
 class QwtPlotSpectrogram::PrivateData
 {
 public:
     PrivateData():
-        data( NULL )
+        data( NULL ),
+        contourAlgorithm( QwtPlotSpectrogram::Conrec )
     {
         colorMap = new QwtLinearColorMap();
         displayMode = ImageMode;
@@ -36,6 +65,8 @@ public:
 #if 0
         conrecFlags |= QwtRasterData::IgnoreOutOfRange;
 #endif
+
+        invalidateContourCache();
     }
     ~PrivateData()
     {
@@ -43,13 +74,31 @@ public:
         delete colorMap;
     }
 
+    void invalidateContourCache()
+    {
+        contourCache.area = QRectF();
+        contourCache.raster = QSize();
+        contourCache.revision = 0;
+        contourCache.polylines.clear();
+    }
+
     QwtRasterData *data;
     QwtColorMap *colorMap;
     DisplayModes displayMode;
+    QwtPlotSpectrogram::ContourAlgorithm contourAlgorithm;
 
     QList<double> contourLevels;
     QPen defaultContourPen;
     QwtRasterData::ConrecFlags conrecFlags;
+
+    struct
+    {
+        QRectF area;
+        QSize raster;
+        uint revision;
+        QwtRasterData::ContourPolylines polylines;
+
+    } contourCache;
 };
 
 /*!
@@ -77,9 +126,46 @@ QwtPlotSpectrogram::QwtPlotSpectrogram( const QString &title ):
 //! Destructor
 QwtPlotSpectrogram::~QwtPlotSpectrogram()
 {
+    // wait for images, that are rendered in background threads
+    invalidateCache();
+
     delete d_data;
 }
 
+/*!
+   Invalidate the paint cache and the cached contour lines
+
+   The contour lines are cached as long as the data, its
+   QwtRasterData::revision(), the contour levels and the CONREC flags
+   don't change. Applications, that modify the values behind the back
+   of the data object, need to call invalidateCache() afterwards.
+
+   \sa QwtPlotRasterItem::invalidateCache()
+*/
+void QwtPlotSpectrogram::invalidateCache()
+{
+    QwtPlotRasterItem::invalidateCache();
+
+    d_data->invalidateContourCache();
+}
+
+/*!
+   Invalidate the cached image for an area and the cached contour lines
+
+   The cached contour lines are only dropped, when they overlap
+   with the area.
+
+   \param area Area in scale coordinates
+   \sa QwtPlotRasterItem::invalidateCacheArea()
+*/
+void QwtPlotSpectrogram::invalidateCacheArea( const QRectF &area )
+{
+    QwtPlotRasterItem::invalidateCacheArea( area );
+
+    if ( d_data->contourCache.area.intersects( area ) )
+        d_data->invalidateContourCache();
+}
+
 //! \return QwtPlotItem::Rtti_PlotSpectrogram
 int QwtPlotSpectrogram::rtti() const
 {
@@ -94,7 +180,11 @@ int QwtPlotSpectrogram::rtti() const
 
    The default setting enables ImageMode.
 
-   \sa DisplayMode, displayMode()
+   \note The contour lines are calculated in the GUI thread. So
+         images are rendered synchronously, while ContourMode is
+         enabled, even if AsynchronousRendering is set.
+
+   \sa DisplayMode, displayMode(), isAsynchronous()
 */
 void QwtPlotSpectrogram::setDisplayMode( DisplayMode mode, bool on )
 {
@@ -104,6 +194,13 @@ void QwtPlotSpectrogram::setDisplayMode( DisplayMode mode, bool on )
             d_data->displayMode |= mode;
         else
             d_data->displayMode &= ~mode;
+
+        if ( mode == ContourMode && on )
+        {
+            // waiting for images, that are rendered in background
+            // threads, before the data is accessed for the contours
+            invalidateCache();
+        }
     }
 
     legendChanged();
@@ -134,14 +231,14 @@ bool QwtPlotSpectrogram::testDisplayMode( DisplayMode mode ) const
 */
 void QwtPlotSpectrogram::setColorMap( QwtColorMap *colorMap )
 {
+    invalidateCache();
+
     if ( d_data->colorMap != colorMap )
     {
         delete d_data->colorMap;
         d_data->colorMap = colorMap;
     }
 
-    invalidateCache();
-
     legendChanged();
     itemChanged();
 }
@@ -226,6 +323,38 @@ QPen QwtPlotSpectrogram::contourPen( double level ) const
     return QPen( c );
 }
 
+/*!
+   \brief Select the algorithm for the contour lines
+
+   The default algorithm is Conrec. MarchingSquares is significantly
+   faster for large rasters and caches the contour lines, but
+   reimplementations of renderContourLines() or drawContourLines(),
+   or of QwtRasterData::contourLines() are not called anymore.
+
+   \param algorithm Contour algorithm
+   \sa contourAlgorithm(), draw()
+*/
+void QwtPlotSpectrogram::setContourAlgorithm( ContourAlgorithm algorithm )
+{
+    if ( algorithm != d_data->contourAlgorithm )
+    {
+        d_data->contourAlgorithm = algorithm;
+        d_data->invalidateContourCache();
+
+        itemChanged();
+    }
+}
+
+/*!
+   \return Algorithm for the contour lines
+   \sa setContourAlgorithm()
+*/
+QwtPlotSpectrogram::ContourAlgorithm
+QwtPlotSpectrogram::contourAlgorithm() const
+{
+    return d_data->contourAlgorithm;
+}
+
 /*!
    Modify an attribute of the CONREC algorithm, used to calculate
    the contour lines.
@@ -233,7 +362,7 @@ QPen QwtPlotSpectrogram::contourPen( double level ) const
    \param flag CONREC flag
    \param on On/Off
 
-   \sa testConrecFlag(), renderContourLines(),
+   \sa testConrecFlag(), renderContourPolylines(),
        QwtRasterData::contourLines()
 */
 void QwtPlotSpectrogram::setConrecFlag(
@@ -247,6 +376,8 @@ void QwtPlotSpectrogram::setConrecFlag(
     else
         d_data->conrecFlags &= ~flag;
 
+    d_data->invalidateContourCache();
+
     itemChanged();
 }
 
@@ -259,7 +390,7 @@ void QwtPlotSpectrogram::setConrecFlag(
 
    The default setting enables QwtRasterData::IgnoreAllVerticesOnLevel
 
-   \sa setConrecClag(), renderContourLines(),
+   \sa setConrecClag(), renderContourPolylines(),
        QwtRasterData::contourLines()
 */
 bool QwtPlotSpectrogram::testConrecFlag(
@@ -272,7 +403,7 @@ bool QwtPlotSpectrogram::testConrecFlag(
    Set the levels of the contour lines
 
    \param levels Values of the contour levels
-   \sa contourLevels(), renderContourLines(),
+   \sa contourLevels(), renderContourPolylines(),
        QwtRasterData::contourLines()
 
    \note contourLevels returns the same levels but sorted.
@@ -282,6 +413,8 @@ void QwtPlotSpectrogram::setContourLevels( const QList<double> &levels )
     d_data->contourLevels = levels;
     qSort( d_data->contourLevels );
 
+    d_data->invalidateContourCache();
+
     legendChanged();
     itemChanged();
 }
@@ -291,7 +424,7 @@ void QwtPlotSpectrogram::setContourLevels( const QList<double> &levels )
 
    The levels are sorted in increasing order.
 
-   \sa contourLevels(), renderContourLines(),
+   \sa contourLevels(), renderContourPolylines(),
        QwtRasterData::contourLines()
 */
 QList<double> QwtPlotSpectrogram::contourLevels() const
@@ -309,10 +442,11 @@ void QwtPlotSpectrogram::setData( QwtRasterData *data )
 {
     if ( data != d_data->data )
     {
+        invalidateCache();
+
         delete d_data->data;
         d_data->data = data;
 
-        invalidateCache();
         itemChanged();
     }
 }
@@ -380,6 +514,8 @@ QRectF QwtPlotSpectrogram::pixelHint( const QRectF &area ) const
    \brief Render an image from data and color map.
 
    For each pixel of area the value is mapped into a color.
+   The tiles of the image are distributed over renderThreadCount()
+   threads by tileScheduler().
 
   \param xMap X-Scale Map
   \param yMap Y-Scale Map
@@ -390,7 +526,7 @@ QRectF QwtPlotSpectrogram::pixelHint( const QRectF &area ) const
            on the color map.
 
    \sa QwtRasterData::value(), QwtColorMap::rgb(),
-       QwtColorMap::colorIndex()
+       QwtColorMap::colorIndex(), QwtRasterTileScheduler
 */
 QImage QwtPlotSpectrogram::renderImage(
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
@@ -414,42 +550,27 @@ QImage QwtPlotSpectrogram::renderImage(
     if ( d_data->colorMap->format() == QwtColorMap::Indexed )
         image.setColorTable( d_data->colorMap->colorTable( intensityRange ) );
 
-    d_data->data->initRaster( area, image.size() );
+    // the coordinates of the pixels, shared by all tiles
 
-#if QT_VERSION >= 0x040400 && !defined(QT_NO_QFUTURE)
-    uint numThreads = renderThreadCount();
+    QVector<double> xValues( imageSize.width() );
+    for ( int i = 0; i < xValues.size(); i++ )
+        xValues[i] = xMap.invTransform( i );
 
-    if ( numThreads <= 0 )
-        numThreads = QThread::idealThreadCount();
+    QVector<double> yValues( imageSize.height() );
+    for ( int i = 0; i < yValues.size(); i++ )
+        yValues[i] = yMap.invTransform( i );
 
-    if ( numThreads <= 0 )
-        numThreads = 1;
+    d_data->data->initRaster( area, image.size() );
 
-    const int numRows = imageSize.height() / numThreads;
+    QwtRasterData::RasterCoordinates *raster =
+        d_data->data->initRasterCoordinates(
+            xValues.constData(), xValues.size(),
+            yValues.constData(), yValues.size() );
 
-    QList< QFuture<void> > futures;
-    for ( uint i = 0; i < numThreads; i++ )
-    {
-        QRect tile( 0, i * numRows, image.width(), numRows );
-        if ( i == numThreads - 1 )
-        {
-            tile.setHeight( image.height() - i * numRows );
-            renderTile( xMap, yMap, tile, &image );
-        }
-        else
-        {
-            futures += QtConcurrent::run(
-                this, &QwtPlotSpectrogram::renderTile,
-                xMap, yMap, tile, &image );
-        }
-    }
-    for ( int i = 0; i < futures.size(); i++ )
-        futures[i].waitForFinished();
+    TileRenderer renderer( this, raster, &image );
+    tileScheduler()->render( imageSize, &renderer, renderThreadCount() );
 
-#else // QT_VERSION < 0x040400
-    const QRect tile( 0, 0, image.width(), image.height() );
-    renderTile( xMap, yMap, tile, &image );
-#endif
+    delete raster;
 
     d_data->data->discardRaster();
 
@@ -470,45 +591,72 @@ QImage QwtPlotSpectrogram::renderImage(
 void QwtPlotSpectrogram::renderTile(
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
     const QRect &tile, QImage *image ) const
+{
+    if ( d_data->data == NULL )
+        return;
+
+    QVector<double> xValues( tile.width() );
+    for ( int i = 0; i < xValues.size(); i++ )
+        xValues[i] = xMap.invTransform( tile.left() + i );
+
+    QVector<double> yValues( tile.height() );
+    for ( int i = 0; i < yValues.size(); i++ )
+        yValues[i] = yMap.invTransform( tile.top() + i );
+
+    QwtRasterData::RasterCoordinates *raster =
+        d_data->data->initRasterCoordinates(
+            xValues.constData(), xValues.size(),
+            yValues.constData(), yValues.size() );
+
+    renderTileRows( raster, QPoint( 0, 0 ), tile, image );
+
+    delete raster;
+}
+
+/*
+  Render a tile from a raster of the raster data: pos is the position
+  of the tile in the raster, tile its geometry in the image. When
+  rendering an image the raster covers the complete image.
+ */
+void QwtPlotSpectrogram::renderTileRows(
+    const QwtRasterData::RasterCoordinates *raster,
+    const QPoint &pos, const QRect &tile, QImage *image ) const
 {
     const QwtInterval range = d_data->data->interval( Qt::ZAxis );
     if ( !range.isValid() )
         return;
 
+    const int numX = tile.width();
+
+    QVector<double> values( numX );
+
     if ( d_data->colorMap->format() == QwtColorMap::RGB )
     {
-        for ( int y = tile.top(); y <= tile.bottom(); y++ )
+        for ( int row = 0; row < tile.height(); row++ )
         {
-            const double ty = yMap.invTransform( y );
+            d_data->data->rasterValues( raster,
+                pos.x(), numX, pos.y() + row, 1, values.data() );
 
-            QRgb *line = reinterpret_cast<QRgb *>( image->scanLine( y ) );
+            QRgb *line = reinterpret_cast<QRgb *>(
+                image->scanLine( tile.top() + row ) );
             line += tile.left();
 
-            for ( int x = tile.left(); x <= tile.right(); x++ )
-            {
-                const double tx = xMap.invTransform( x );
-
-                *line++ = d_data->colorMap->rgb( range,
-                    d_data->data->value( tx, ty ) );
-            }
+            d_data->colorMap->rgbValues( range,
+                values.constData(), numX, line );
         }
     }
     else if ( d_data->colorMap->format() == QwtColorMap::Indexed )
     {
-        for ( int y = tile.top(); y <= tile.bottom(); y++ )
+        for ( int row = 0; row < tile.height(); row++ )
         {
-            const double ty = yMap.invTransform( y );
+            d_data->data->rasterValues( raster,
+                pos.x(), numX, pos.y() + row, 1, values.data() );
 
-            unsigned char *line = image->scanLine( y );
+            unsigned char *line = image->scanLine( tile.top() + row );
             line += tile.left();
 
-            for ( int x = tile.left(); x <= tile.right(); x++ )
-            {
-                const double tx = xMap.invTransform( x );
-
-                *line++ = d_data->colorMap->colorIndex( range,
-                    d_data->data->value( tx, ty ) );
-            }
+            d_data->colorMap->colorIndexes( range,
+                values.constData(), numX, line );
         }
     }
 }
@@ -553,6 +701,10 @@ QSize QwtPlotSpectrogram::contourRasterSize(
    \param raster Raster, used by the CONREC algorithm
    \return Calculated contour lines
 
+   \note draw() uses renderContourLines() only for the Conrec
+         algorithm. For MarchingSquares it uses renderContourPolylines(),
+         that is significantly faster for large rasters.
+
    \sa contourLevels(), setConrecFlag(),
        QwtRasterData::contourLines()
 */
@@ -574,7 +726,10 @@ QwtRasterData::ContourLines QwtPlotSpectrogram::renderContourLines(
    \param yMap Maps y-values into pixel coordinates.
    \param contourLines Contour lines
 
-   \sa renderContourLines(), defaultContourPen(), contourPen()
+   \note draw() uses drawContourLines() only for the Conrec algorithm
+
+   \sa renderContourLines(), defaultContourPen(), contourPen(),
+       setContourAlgorithm()
 */
 void QwtPlotSpectrogram::drawContourLines( QPainter *painter,
         const QwtScaleMap &xMap, const QwtScaleMap &yMap,
@@ -610,6 +765,191 @@ void QwtPlotSpectrogram::drawContourLines( QPainter *painter,
     }
 }
 
+/*!
+   Calculate contour lines as connected polylines
+
+   The calculation is distributed over renderThreadCount() threads.
+
+   \param rect Rectangle, where to calculate the contour lines
+   \param raster Raster, where to sample the values
+   \return Calculated contour lines
+
+   \sa contourLevels(), setConrecFlag(),
+       QwtRasterData::contourPolylines(), QwtPlotItem::setRenderThreadCount()
+*/
+QwtRasterData::ContourPolylines QwtPlotSpectrogram::renderContourPolylines(
+    const QRectF &rect, const QSize &raster ) const
+{
+    if ( d_data->data == NULL )
+        return QwtRasterData::ContourPolylines();
+
+    const int numThreads = renderThreadCount();
+
+    return d_data->data->contourPolylines( rect, raster,
+        d_data->contourLevels, d_data->conrecFlags, numThreads );
+}
+
+/*!
+   Paint the contour lines
+
+   \param painter Painter
+   \param xMap Maps x-values into pixel coordinates.
+   \param yMap Maps y-values into pixel coordinates.
+   \param contourPolylines Contour lines
+
+   \sa renderContourPolylines(), defaultContourPen(), contourPen()
+*/
+void QwtPlotSpectrogram::drawContourPolylines( QPainter *painter,
+        const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QwtRasterData::ContourPolylines &contourPolylines ) const
+{
+    if ( d_data->data == NULL )
+        return;
+
+    QPolygonF points;
+
+    const int numLevels = d_data->contourLevels.size();
+    for ( int l = 0; l < numLevels; l++ )
+    {
+        const double level = d_data->contourLevels[l];
+
+        QwtRasterData::ContourPolylines::const_iterator it =
+            contourPolylines.find( level );
+        if ( it == contourPolylines.end() )
+            continue;
+
+        QPen pen = defaultContourPen();
+        if ( pen.style() == Qt::NoPen )
+            pen = contourPen( level );
+
+        if ( pen.style() == Qt::NoPen )
+            continue;
+
+        painter->setPen( pen );
+
+        const QVector<QPolygonF> &polylines = it.value();
+        for ( int i = 0; i < polylines.size(); i++ )
+        {
+            const QPolygonF &polyline = polylines[i];
+
+            points.resize( polyline.size() );
+            QwtScaleMap::transform( xMap, yMap,
+                polyline.constData(), points.data(), polyline.size() );
+
+            QwtPainter::drawPolyline( painter, points );
+        }
+    }
+}
+
+/*!
+   \brief Check if images for the canvas are rendered in the background
+
+   As the contour lines are calculated from the data in the GUI
+   thread, images are rendered synchronously in ContourMode.
+
+   \return True, when AsynchronousRendering is enabled and
+           ContourMode is not set
+   \sa QwtPlotRasterItem::isAsynchronous(), setDisplayMode()
+*/
+bool QwtPlotSpectrogram::isAsynchronous() const
+{
+    if ( d_data->displayMode & ContourMode )
+        return false;
+
+    return QwtPlotRasterItem::isAsynchronous();
+}
+
+/*!
+   \brief Find the contour lines in the cache or calculate them
+
+   As the contour lines are in plot coordinates, the cached lines
+   can be painted for other scale maps as long as they cover the
+   requested area and the resolution of their raster is similar.
+   So panning, zooming in small steps, replots for other reasons and
+   exports by QwtPlotRenderer don't need to recalculate them.
+
+   When the contour lines need to be recalculated, because the view
+   has been moved out of a valid cache entry of a similar resolution,
+   the area is extended by a margin in the direction of the movement,
+   so that they can be reused for the following steps of panning.
+   Otherwise - f.e. after the data has been modified - only the
+   requested area is calculated.
+
+   \param area Area, where the contour lines are needed
+   \param raster Raster for the area
+   \return Contour lines
+
+   \sa renderContourPolylines(), invalidateCache()
+*/
+QwtRasterData::ContourPolylines QwtPlotSpectrogram::cachedContourPolylines(
+    const QRectF &area, const QSize &raster ) const
+{
+    const double resX = area.width() / raster.width();
+    const double resY = area.height() / raster.height();
+
+    PrivateData *d = d_data;
+
+    const uint revision = d->data ? d->data->revision() : 0;
+
+    bool isPanning = false;
+
+    if ( d->contourCache.raster.isValid() &&
+        d->contourCache.revision == revision )
+    {
+        const QRectF &cachedArea = d->contourCache.area;
+
+        const double cachedResX =
+            cachedArea.width() / d->contourCache.raster.width();
+        const double cachedResY =
+            cachedArea.height() / d->contourCache.raster.height();
+
+        if ( qwtIsSimilarResolution( cachedResX, resX ) &&
+            qwtIsSimilarResolution( cachedResY, resY ) )
+        {
+            if ( cachedArea.contains( area ) )
+                return d->contourCache.polylines;
+
+            isPanning = cachedArea.intersects( area );
+        }
+    }
+
+    QRectF cacheArea = area;
+
+    if ( isPanning )
+    {
+        // a margin of 25% on the sides, where the view left the cache
+
+        const QRectF &cachedArea = d->contourCache.area;
+
+        const double dx = 0.25 * area.width();
+        const double dy = 0.25 * area.height();
+
+        if ( area.left() < cachedArea.left() )
+            cacheArea.setLeft( area.left() - dx );
+        if ( area.right() > cachedArea.right() )
+            cacheArea.setRight( area.right() + dx );
+        if ( area.top() < cachedArea.top() )
+            cacheArea.setTop( area.top() - dy );
+        if ( area.bottom() > cachedArea.bottom() )
+            cacheArea.setBottom( area.bottom() + dy );
+    }
+
+    const QRectF br = boundingRect();
+    if ( br.isValid() )
+        cacheArea &= br;
+
+    const QSize cacheRaster( qRound( cacheArea.width() / resX ),
+        qRound( cacheArea.height() / resY ) );
+
+    d->contourCache.area = cacheArea;
+    d->contourCache.raster = cacheRaster;
+    d->contourCache.revision = revision;
+    d->contourCache.polylines =
+        renderContourPolylines( cacheArea, cacheRaster );
+
+    return d->contourCache.polylines;
+}
+
 /*!
   \brief Draw the spectrogram
 
@@ -618,8 +958,8 @@ void QwtPlotSpectrogram::drawContourLines( QPainter *painter,
   \param yMap Maps y-values into pixel coordinates.
   \param canvasRect Contents rectangle of the canvas in painter coordinates
 
-  \sa setDisplayMode(), renderImage(),
-      QwtPlotRasterItem::draw(), drawContourLines()
+  \sa setDisplayMode(), setContourAlgorithm(), renderImage(),
+      QwtPlotRasterItem::draw(), drawContourPolylines(), drawContourLines()
 */
 void QwtPlotSpectrogram::draw( QPainter *painter,
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
@@ -651,10 +991,20 @@ void QwtPlotSpectrogram::draw( QPainter *painter,
         raster = raster.boundedTo( rasterRect.toRect().size() );
         if ( raster.isValid() )
         {
-            const QwtRasterData::ContourLines lines =
-                renderContourLines( area, raster );
+            if ( d_data->contourAlgorithm == Conrec )
+            {
+                const QwtRasterData::ContourLines lines =
+                    renderContourLines( area, raster );
 
-            drawContourLines( painter, xMap, yMap, lines );
+                drawContourLines( painter, xMap, yMap, lines );
+            }
+            else
+            {
+                const QwtRasterData::ContourPolylines polylines =
+                    cachedContourPolylines( area, raster );
+
+                drawContourPolylines( painter, xMap, yMap, polylines );
+            }
         }
     }
 }
@@ -30,6 +30,10 @@ class QwtColorMap;
 
   In ContourMode contour lines are painted for the contour levels.
 
+  By default the contour lines are calculated by the CONREC algorithm.
+  For large rasters the MarchingSquares algorithm is significantly
+  faster ( see setContourAlgorithm() ).
+
   \image html spectrogram3.png
 
   \sa QwtRasterData, QwtColorMap, QwtPlotItem::setRenderThreadCount()
@@ -55,6 +59,26 @@ public:
     //! Display modes
     typedef QFlags<DisplayMode> DisplayModes;
 
+    /*!
+      Algorithm, that is used by draw() for the contour lines
+      \sa setContourAlgorithm(), contourAlgorithm()
+     */
+    enum ContourAlgorithm
+    {
+        /*!
+          Connected polylines calculated by a parallel marching squares
+          algorithm: renderContourPolylines(), drawContourPolylines().
+          The contour lines are cached across replots.
+         */
+        MarchingSquares,
+
+        /*!
+          Line segments calculated by the CONREC algorithm:
+          renderContourLines(), drawContourLines(). ( default )
+         */
+        Conrec
+    };
+
     explicit QwtPlotSpectrogram( const QString &title = QString::null );
     virtual ~QwtPlotSpectrogram();
 
@@ -78,12 +102,18 @@ public:
 
     virtual QPen contourPen( double level ) const;
 
+    void setContourAlgorithm( ContourAlgorithm );
+    ContourAlgorithm contourAlgorithm() const;
+
     void setConrecFlag( QwtRasterData::ConrecFlag, bool on );
     bool testConrecFlag( QwtRasterData::ConrecFlag ) const;
 
     void setContourLevels( const QList<double> & );
     QList<double> contourLevels() const;
 
+    virtual void invalidateCache();
+    virtual void invalidateCacheArea( const QRectF & );
+
     virtual int rtti() const;
 
     virtual void draw( QPainter *p,
@@ -105,10 +135,27 @@ protected:
         const QwtScaleMap &xMap, const QwtScaleMap &yMap,
         const QwtRasterData::ContourLines& lines ) const;
 
+    virtual QwtRasterData::ContourPolylines renderContourPolylines(
+        const QRectF &rect, const QSize &raster ) const;
+
+    virtual void drawContourPolylines( QPainter *p,
+        const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QwtRasterData::ContourPolylines& polylines ) const;
+
+    virtual bool isAsynchronous() const;
+
     void renderTile( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
         const QRect &imageRect, QImage *image ) const;
 
 private:
+    class TileRenderer;
+
+    void renderTileRows( const QwtRasterData::RasterCoordinates *,
+        const QPoint &pos, const QRect &tile, QImage *image ) const;
+
+    QwtRasterData::ContourPolylines cachedContourPolylines(
+        const QRectF &area, const QSize &raster ) const;
+
     class PrivateData;
     PrivateData *d_data;
 };
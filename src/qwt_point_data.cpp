@@ -9,8 +9,130 @@
 
 #include "qwt_point_data.h"
 #include "qwt_math.h"
+#include "qwt_simd_p.h"
+#include <qalgorithms.h>
+#include <qnumeric.h>
 #include <string.h>
 
+/*
+  Minimum and maximum of an array of values. NaN values
+  are ignored, for an array without any valid value
+  min > max is returned.
+
+  Note, that the min/max instructions return the second
+  operand, when one of them is NaN.
+ */
+static void qwtMinMax( const double *values, size_t size,
+    double &min, double &max )
+{
+    double lo = qInf();
+    double hi = -qInf();
+
+    size_t i = 0;
+
+#if QWT_USE_AVX
+    if ( size >= 4 )
+    {
+        __m256d vmin = _mm256_set1_pd( lo );
+        __m256d vmax = _mm256_set1_pd( hi );
+
+        for ( ; i + 4 <= size; i += 4 )
+        {
+            const __m256d v = _mm256_loadu_pd( values + i );
+
+            vmin = _mm256_min_pd( v, vmin );
+            vmax = _mm256_max_pd( v, vmax );
+        }
+
+        double l[4];
+        double h[4];
+
+        _mm256_storeu_pd( l, vmin );
+        _mm256_storeu_pd( h, vmax );
+
+        lo = qMin( qMin( l[0], l[1] ), qMin( l[2], l[3] ) );
+        hi = qMax( qMax( h[0], h[1] ), qMax( h[2], h[3] ) );
+    }
+#elif QWT_USE_SSE2
+    if ( size >= 4 )
+    {
+        __m128d vmin1 = _mm_set1_pd( lo );
+        __m128d vmax1 = _mm_set1_pd( hi );
+        __m128d vmin2 = vmin1;
+        __m128d vmax2 = vmax1;
+
+        for ( ; i + 4 <= size; i += 4 )
+        {
+            const __m128d v1 = _mm_loadu_pd( values + i );
+            const __m128d v2 = _mm_loadu_pd( values + i + 2 );
+
+            vmin1 = _mm_min_pd( v1, vmin1 );
+            vmax1 = _mm_max_pd( v1, vmax1 );
+            vmin2 = _mm_min_pd( v2, vmin2 );
+            vmax2 = _mm_max_pd( v2, vmax2 );
+        }
+
+        double l[2];
+        double h[2];
+
+        _mm_storeu_pd( l, _mm_min_pd( vmin1, vmin2 ) );
+        _mm_storeu_pd( h, _mm_max_pd( vmax1, vmax2 ) );
+
+        lo = qMin( l[0], l[1] );
+        hi = qMax( h[0], h[1] );
+    }
+#endif
+
+    for ( ; i < size; i++ )
+    {
+        const double v = values[i];
+
+        if ( v < lo )
+            lo = v;
+
+        if ( v > hi )
+            hi = v;
+    }
+
+    min = lo;
+    max = hi;
+}
+
+static QRectF qwtArrayBoundingRect( const double *x,
+    const double *y, size_t size )
+{
+    double minX, maxX, minY, maxY;
+
+    qwtMinMax( x, size, minX, maxX );
+    qwtMinMax( y, size, minY, maxY );
+
+    if ( minX > maxX || minY > maxY )
+        return QRectF( 1.0, 1.0, -2.0, -2.0 ); // invalid
+
+    return QRectF( minX, minY, maxX - minX, maxY - minY );
+}
+
+/*
+  Extend a cached bounding rectangle by the rectangle of 
+  appended samples. A cache, that has not been calculated yet,
+  will be calculated completely, when being requested.
+ */
+static void qwtExtendRect( QRectF &boundingRect, const QRectF &rect )
+{
+    if ( boundingRect.width() < 0.0 || rect.width() < 0.0 )
+        return;
+
+    boundingRect.setLeft( qMin( boundingRect.left(), rect.left() ) );
+    boundingRect.setRight( qMax( boundingRect.right(), rect.right() ) );
+    boundingRect.setTop( qMin( boundingRect.top(), rect.top() ) );
+    boundingRect.setBottom( qMax( boundingRect.bottom(), rect.bottom() ) );
+}
+
+//! Constructor for an empty series
+QwtPointArrayData::QwtPointArrayData()
+{
+}
+
 /*!
   Constructor
 
@@ -44,18 +166,78 @@ QwtPointArrayData::QwtPointArrayData( const double *x,
     ::memcpy( d_y.data(), y, size * sizeof( double ) );
 }
 
+/*!
+  Append a sample
+
+  \param x x value
+  \param y y value
+
+  \sa clear()
+*/
+void QwtPointArrayData::append( double x, double y )
+{
+    append( &x, &y, 1 );
+}
+
+/*!
+  Append samples
+
+  \param x Array of x values
+  \param y Array of y values
+  \param size Size of the x and y arrays
+
+  \sa clear()
+*/
+void QwtPointArrayData::append( const double *x, 
+    const double *y, size_t size )
+{
+    if ( size == 0 )
+        return;
+
+    const int oldSize = d_x.size();
+
+    d_x.resize( oldSize + int( size ) );
+    ::memcpy( d_x.data() + oldSize, x, size * sizeof( double ) );
+
+    d_y.resize( oldSize + int( size ) );
+    ::memcpy( d_y.data() + oldSize, y, size * sizeof( double ) );
+
+    qwtExtendRect( d_boundingRect, qwtArrayBoundingRect( x, y, size ) );
+
+    incrementRevision();
+}
+
+/*!
+  Remove all samples
+  \sa append()
+*/
+void QwtPointArrayData::clear()
+{
+    d_x.clear();
+    d_y.clear();
+
+    d_boundingRect = QRectF( 0.0, 0.0, -1.0, -1.0 );
+
+    incrementRevision();
+}
+
 /*!
   \brief Calculate the bounding rectangle
 
   The bounding rectangle is calculated once by iterating over all
-  points and is stored for all following requests.
+  points and is stored for all following requests. 
+  Appending samples extends it without iterating again.
 
   \return Bounding rectangle
+  \note NaN values are ignored
 */
 QRectF QwtPointArrayData::boundingRect() const
 {
     if ( d_boundingRect.width() < 0 )
-        d_boundingRect = qwtBoundingRect( *this );
+    {
+        d_boundingRect = qwtArrayBoundingRect( 
+            d_x.constData(), d_y.constData(), size() );
+    }
 
     return d_boundingRect;
 }
@@ -77,6 +259,26 @@ QPointF QwtPointArrayData::sample( size_t index ) const
     return QPointF( d_x[int( index )], d_y[int( index )] );
 }
 
+/*!
+  Copy a range of samples into a buffer
+
+  \param from Index of the first sample
+  \param numSamples Number of samples to copy
+  \param samples Buffer for at least numSamples samples
+*/
+void QwtPointArrayData::copySamples( 
+    size_t from, size_t numSamples, QPointF *samples ) const
+{
+    const double *x = d_x.constData() + from;
+    const double *y = d_y.constData() + from;
+
+    for ( size_t i = 0; i < numSamples; i++ )
+    {
+        samples[i].rx() = x[i];
+        samples[i].ry() = y[i];
+    }
+}
+
 //! \return Array of the x-values
 const QVector<double> &QwtPointArrayData::xData() const
 {
@@ -110,6 +312,41 @@ QwtCPointerData::QwtCPointerData(
 {
 }
 
+/*!
+  \brief Change the number of samples
+
+  When the size increases, the bounding rectangle is extended by the
+  additional samples, while the samples in front are expected to
+  be unmodified. Otherwise the bounding rectangle will be 
+  recalculated completely.
+
+  \param size Size of the x and y arrays
+
+  \warning The memory blocks need to have space for size values
+  \note Samples, that have been modified in place, need to be announced
+        by incrementRevision()
+*/
+void QwtCPointerData::setSize( size_t size )
+{
+    if ( size > d_size )
+    {
+        const QRectF rect = qwtArrayBoundingRect( 
+            d_x + d_size, d_y + d_size, size - d_size );
+
+        qwtExtendRect( d_boundingRect, rect );
+    }
+    else if ( size < d_size )
+    {
+        d_boundingRect = QRectF( 0.0, 0.0, -1.0, -1.0 );
+    }
+
+    if ( size != d_size )
+    {
+        d_size = size;
+        incrementRevision();
+    }
+}
+
 /*!
   \brief Calculate the bounding rectangle
 
@@ -117,11 +354,12 @@ QwtCPointerData::QwtCPointerData(
   points and is stored for all following requests.
 
   \return Bounding rectangle
+  \note NaN values are ignored
 */
 QRectF QwtCPointerData::boundingRect() const
 {
     if ( d_boundingRect.width() < 0 )
-        d_boundingRect = qwtBoundingRect( *this );
+        d_boundingRect = qwtArrayBoundingRect( d_x, d_y, d_size );
 
     return d_boundingRect;
 }
@@ -143,6 +381,26 @@ QPointF QwtCPointerData::sample( size_t index ) const
     return QPointF( d_x[int( index )], d_y[int( index )] );
 }
 
+/*!
+  Copy a range of samples into a buffer
+
+  \param from Index of the first sample
+  \param numSamples Number of samples to copy
+  \param samples Buffer for at least numSamples samples
+*/
+void QwtCPointerData::copySamples( 
+    size_t from, size_t numSamples, QPointF *samples ) const
+{
+    const double *x = d_x + from;
+    const double *y = d_y + from;
+
+    for ( size_t i = 0; i < numSamples; i++ )
+    {
+        samples[i].rx() = x[i];
+        samples[i].ry() = y[i];
+    }
+}
+
 //! \return Array of the x-values
 const double *QwtCPointerData::xData() const
 {
@@ -155,6 +413,579 @@ const double *QwtCPointerData::yData() const
     return d_y;
 }
 
+// number of samples, that are represented by a bucket of the lowest level
+static const int qwtPyramidBucketSize = 8;
+
+class QwtPyramidBucket
+{
+public:
+    // indexes of the first and last sample and of the samples
+    // with the minimum/maximum y values
+    int first;
+    int minimum;
+    int maximum;
+    int last;
+};
+
+// a bucket is displayed by 4 points: first, the extremes, last
+static const int qwtPyramidBucketPoints = 4;
+
+static inline int qwtBucketPoint( const QwtPyramidBucket &bucket, int pos )
+{
+    // the extremes in the order of the series
+    switch( pos )
+    {
+        case 0:
+            return bucket.first;
+        case 1:
+            return qMin( bucket.minimum, bucket.maximum );
+        case 2:
+            return qMax( bucket.minimum, bucket.maximum );
+        default:
+            return bucket.last;
+    }
+}
+
+static inline void qwtInitBucket( QwtPyramidBucket &bucket,
+    const double *y, int from, int to )
+{
+    int minIndex = from;
+    int maxIndex = from;
+
+    for ( int i = from + 1; i <= to; i++ )
+    {
+        if ( y[i] < y[minIndex] )
+            minIndex = i;
+        else if ( y[i] > y[maxIndex] )
+            maxIndex = i;
+    }
+
+    bucket.first = from;
+    bucket.minimum = minIndex;
+    bucket.maximum = maxIndex;
+    bucket.last = to;
+}
+
+static inline void qwtMergeBuckets( QwtPyramidBucket &bucket,
+    const double *y, const QwtPyramidBucket &bucket1,
+    const QwtPyramidBucket &bucket2 )
+{
+    bucket.first = bucket1.first;
+
+    bucket.minimum = ( y[bucket1.minimum] <= y[bucket2.minimum] )
+        ? bucket1.minimum : bucket2.minimum;
+
+    bucket.maximum = ( y[bucket1.maximum] >= y[bucket2.maximum] )
+        ? bucket1.maximum : bucket2.maximum;
+
+    bucket.last = bucket2.last;
+}
+
+class QwtPointPyramidData::PrivateData
+{
+public:
+    PrivateData():
+        resolution( 4000 ),
+        level( 0 ),
+        from( 0 ),
+        to( -1 )
+    {
+    }
+
+    QVector<double> x;
+    QVector<double> y;
+
+    // levels[k] has buckets of qwtPyramidBucketSize * 2^k samples
+    QVector< QVector<QwtPyramidBucket> > levels;
+
+    int resolution;
+    QRectF rectOfInterest;
+
+    // the current view: samples or buckets from -> to of a level
+    int level;
+    int from;
+    int to;
+};
+
+//! Constructor
+QwtPointPyramidData::QwtPointPyramidData()
+{
+    d_data = new PrivateData();
+}
+
+/*!
+  Constructor
+
+  \param x Array of x values in increasing order
+  \param y Array of y values
+
+  \sa setSamples(), append()
+*/
+QwtPointPyramidData::QwtPointPyramidData(
+    const QVector<double> &x, const QVector<double> &y )
+{
+    d_data = new PrivateData();
+    setSamples( x, y );
+}
+
+/*!
+  Constructor
+
+  \param x Array of x values in increasing order
+  \param y Array of y values
+  \param size Size of the x and y arrays
+
+  \sa setSamples(), append()
+*/
+QwtPointPyramidData::QwtPointPyramidData( 
+    const double *x, const double *y, size_t size )
+{
+    d_data = new PrivateData();
+    append( x, y, size );
+}
+
+//! Destructor
+QwtPointPyramidData::~QwtPointPyramidData()
+{
+    delete d_data;
+}
+
+/*!
+  Assign the samples and rebuild the pyramid
+
+  \param x Array of x values in increasing order
+  \param y Array of y values
+
+  \sa append(), clear()
+*/
+void QwtPointPyramidData::setSamples( 
+    const QVector<double> &x, const QVector<double> &y )
+{
+    const int size = qMin( x.size(), y.size() );
+
+    d_data->x = x;
+    d_data->x.resize( size );
+
+    d_data->y = y;
+    d_data->y.resize( size );
+
+    d_data->levels.clear();
+
+    updateLevels( 0 );
+    updateView();
+
+    incrementRevision();
+}
+
+/*!
+  Append a sample
+
+  \param x x value, that must not be smaller than the x value
+           of the last sample
+  \param y y value
+
+  \sa setSamples()
+*/
+void QwtPointPyramidData::append( double x, double y )
+{
+    append( &x, &y, 1 );
+}
+
+/*!
+  \brief Append samples
+
+  Only the buckets covering the new samples are updated, what
+  makes the costs depend on the number of new samples only.
+
+  \param x Array of x values in increasing order. The first value 
+           must not be smaller than the x value of the last sample
+  \param y Array of y values
+  \param size Size of the x and y arrays
+
+  \sa setSamples()
+*/
+void QwtPointPyramidData::append( 
+    const double *x, const double *y, size_t size )
+{
+    if ( size == 0 )
+        return;
+
+    const int from = d_data->x.size();
+
+    d_data->x.resize( from + int( size ) );
+    ::memcpy( d_data->x.data() + from, x, size * sizeof( double ) );
+
+    d_data->y.resize( from + int( size ) );
+    ::memcpy( d_data->y.data() + from, y, size * sizeof( double ) );
+
+    updateLevels( from );
+    updateView();
+
+    incrementRevision();
+}
+
+/*!
+  Remove all samples
+  \sa setSamples(), append()
+ */
+void QwtPointPyramidData::clear()
+{
+    d_data->x.clear();
+    d_data->y.clear();
+    d_data->levels.clear();
+
+    updateView();
+
+    incrementRevision();
+}
+
+/*!
+  \brief Set the resolution
+
+  The resolution is the maximum for the number of buckets
+  in the rectangle of interest. To have the same result as 
+  when displaying all samples it should not be smaller than the
+  width of the plot canvas in pixels.
+
+  The default setting is 4000.
+
+  \param numBuckets Maximum for the number of buckets
+  \sa resolution(), setRectOfInterest()
+ */
+void QwtPointPyramidData::setResolution( int numBuckets )
+{
+    numBuckets = qMax( numBuckets, 1 );
+    if ( numBuckets != d_data->resolution )
+    {
+        d_data->resolution = numBuckets;
+        updateView();
+    }
+}
+
+/*!
+  \return Maximum for the number of buckets in the rectangle of interest
+  \sa setResolution()
+ */
+int QwtPointPyramidData::resolution() const
+{
+    return d_data->resolution;
+}
+
+/*!
+  \return Number of levels, including level 0 for the samples
+  \sa currentLevel()
+ */
+int QwtPointPyramidData::levelCount() const
+{
+    return d_data->levels.size() + 1;
+}
+
+/*!
+  \return Level, that has been selected for the rectangle of interest.
+          Level 0 means, that the samples are returned, level k > 0
+          means buckets of 2^(k+2) samples.
+
+  \sa setRectOfInterest(), levelCount()
+ */
+int QwtPointPyramidData::currentLevel() const
+{
+    return d_data->level;
+}
+
+/*!
+  \return Number of samples
+  \sa rawSample(), size()
+ */
+size_t QwtPointPyramidData::numSamples() const
+{
+    return d_data->x.size();
+}
+
+/*!
+  \param index Index
+  \return Sample at position index, regardless of the current level
+  \sa numSamples(), sample()
+ */
+QPointF QwtPointPyramidData::rawSample( size_t index ) const
+{
+    const int i = static_cast<int>( index );
+    return QPointF( d_data->x[i], d_data->y[i] );
+}
+
+/*!
+  \brief Calculate the bounding rectangle
+
+  As the x values are in increasing order and the top level 
+  of the pyramid has the minimum and maximum of all y values
+  this is an O(1) operation.
+
+  \return Bounding rectangle
+*/
+QRectF QwtPointPyramidData::boundingRect() const
+{
+    if ( d_data->levels.isEmpty() )
+        return QRectF( 1.0, 1.0, -2.0, -2.0 ); // invalid
+
+    const QwtPyramidBucket &bucket = d_data->levels.last().at( 0 );
+
+    const double minX = d_data->x.first();
+    const double maxX = d_data->x.last();
+    const double minY = d_data->y[ bucket.minimum ];
+    const double maxY = d_data->y[ bucket.maximum ];
+
+    return QRectF( minX, minY, maxX - minX, maxY - minY );
+}
+
+/*!
+  \return Number of points in the rectangle of interest, 
+          including one point on each side outside of it.
+  \sa setRectOfInterest(), numSamples()
+ */
+size_t QwtPointPyramidData::size() const
+{
+    const int numItems = d_data->to - d_data->from + 1;
+    if ( numItems <= 0 )
+        return 0;
+
+    if ( d_data->level == 0 )
+        return numItems;
+
+    return qwtPyramidBucketPoints * numItems;
+}
+
+/*!
+  Return the point at position i of the current level
+
+  \param index Index
+  \return Sample or extreme of a bucket at position index
+  \sa size(), rawSample()
+ */
+QPointF QwtPointPyramidData::sample( size_t index ) const
+{
+    const int i = static_cast<int>( index );
+
+    if ( d_data->level == 0 )
+    {
+        const int pos = d_data->from + i;
+        return QPointF( d_data->x[pos], d_data->y[pos] );
+    }
+
+    const QwtPyramidBucket &bucket = d_data->levels.at( d_data->level - 1 ).at(
+        d_data->from + i / qwtPyramidBucketPoints );
+
+    const int pos = qwtBucketPoint( bucket, i % qwtPyramidBucketPoints );
+    return QPointF( d_data->x[pos], d_data->y[pos] );
+}
+
+/*!
+  Copy a range of points of the current level into a buffer
+
+  \param from Index of the first point
+  \param numSamples Number of points to copy
+  \param samples Buffer for at least numSamples points
+*/
+void QwtPointPyramidData::copySamples( 
+    size_t from, size_t numSamples, QPointF *samples ) const
+{
+    if ( d_data->level == 0 )
+    {
+        const double *x = d_data->x.constData() + d_data->from + from;
+        const double *y = d_data->y.constData() + d_data->from + from;
+
+        for ( size_t i = 0; i < numSamples; i++ )
+        {
+            samples[i].rx() = x[i];
+            samples[i].ry() = y[i];
+        }
+    }
+    else
+    {
+        const QwtPyramidBucket *buckets = 
+            d_data->levels.at( d_data->level - 1 ).constData() + d_data->from;
+
+        const double *x = d_data->x.constData();
+        const double *y = d_data->y.constData();
+
+        for ( size_t i = 0; i < numSamples; i++ )
+        {
+            const size_t index = from + i;
+            const QwtPyramidBucket &bucket =
+                buckets[ index / qwtPyramidBucketPoints ];
+
+            const int pos = qwtBucketPoint( bucket,
+                int( index % qwtPyramidBucketPoints ) );
+
+            samples[i].rx() = x[pos];
+            samples[i].ry() = y[pos];
+        }
+    }
+}
+
+/*!
+   \brief Set a the "rectangle of interest"
+
+   The level of the pyramid is selected, so that the number of buckets 
+   in the x interval of the rectangle does not exceed the resolution().
+   If the rectangle is invalid all samples are in the interval of interest.
+
+   \param rect Rectangle of interest
+   \sa rectOfInterest(), setResolution(), currentLevel()
+*/
+void QwtPointPyramidData::setRectOfInterest( const QRectF &rect )
+{
+    d_data->rectOfInterest = rect;
+    updateView();
+}
+
+/*!
+   \return "rectangle of interest"
+   \sa setRectOfInterest()
+*/
+QRectF QwtPointPyramidData::rectOfInterest() const
+{
+    return d_data->rectOfInterest;
+}
+
+void QwtPointPyramidData::updateLevels( int from )
+{
+    const int numSamples = d_data->x.size();
+    if ( numSamples == 0 )
+    {
+        d_data->levels.clear();
+        return;
+    }
+
+    const double *y = d_data->y.constData();
+
+    // the buckets from firstBucket to the end are affected
+
+    int firstBucket = from / qwtPyramidBucketSize;
+    int numBuckets = ( numSamples + qwtPyramidBucketSize - 1 ) 
+        / qwtPyramidBucketSize;
+
+    for ( int k = 0; ; k++ )
+    {
+        if ( k == d_data->levels.size() )
+            d_data->levels += QVector<QwtPyramidBucket>();
+
+        QVector<QwtPyramidBucket> &level = d_data->levels[k];
+        level.resize( numBuckets );
+
+        QwtPyramidBucket *buckets = level.data();
+
+        if ( k == 0 )
+        {
+            for ( int i = firstBucket; i < numBuckets; i++ )
+            {
+                const int i1 = i * qwtPyramidBucketSize;
+                const int i2 = qMin( i1 + qwtPyramidBucketSize, numSamples ) - 1;
+
+                qwtInitBucket( buckets[i], y, i1, i2 );
+            }
+        }
+        else
+        {
+            const QVector<QwtPyramidBucket> &lowerLevel = 
+                d_data->levels.at( k - 1 );
+
+            const QwtPyramidBucket *lowerBuckets = lowerLevel.constData();
+            const int numLowerBuckets = lowerLevel.size();
+
+            for ( int i = firstBucket; i < numBuckets; i++ )
+            {
+                const int j = 2 * i;
+
+                if ( j + 1 < numLowerBuckets )
+                {
+                    qwtMergeBuckets( buckets[i], y,
+                        lowerBuckets[j], lowerBuckets[j + 1] );
+                }
+                else
+                {
+                    buckets[i] = lowerBuckets[j];
+                }
+            }
+        }
+
+        if ( numBuckets <= 1 )
+        {
+            d_data->levels.resize( k + 1 );
+            break;
+        }
+
+        firstBucket /= 2;
+        numBuckets = ( numBuckets + 1 ) / 2;
+    }
+}
+
+// select the view and announce a modified view by a new revision
+void QwtPointPyramidData::updateView()
+{
+    const int level = d_data->level;
+    const int from = d_data->from;
+    const int to = d_data->to;
+
+    selectView();
+
+    if ( d_data->level != level || d_data->from != from
+        || d_data->to != to )
+    {
+        incrementRevision();
+    }
+}
+
+void QwtPointPyramidData::selectView()
+{
+    const int numSamples = d_data->x.size();
+
+    d_data->level = 0;
+    d_data->from = 0;
+    d_data->to = numSamples - 1;
+
+    if ( numSamples == 0 )
+        return;
+
+    int from = 0;
+    int to = numSamples - 1;
+
+    const QRectF rect = d_data->rectOfInterest.normalized();
+    if ( rect.width() > 0.0 )
+    {
+        // including the neighbours outside of the interval, so that
+        // the lines to them are displayed
+
+        const double *x = d_data->x.constData();
+        const double *end = x + numSamples;
+
+        from = int( qLowerBound( x, end, rect.left() ) - x ) - 1;
+        to = int( qUpperBound( x, end, rect.right() ) - x );
+
+        from = qBound( 0, from, numSamples - 1 );
+        to = qBound( from, to, numSamples - 1 );
+    }
+
+    const int numPoints = to - from + 1;
+    if ( numPoints > 2 * d_data->resolution )
+    {
+        for ( int k = 0; k < d_data->levels.size(); k++ )
+        {
+            d_data->level = k + 1;
+
+            const int bucketSize = qwtPyramidBucketSize << k;
+            if ( numPoints / bucketSize < d_data->resolution )
+                break;
+        }
+
+        const int bucketSize = qwtPyramidBucketSize << ( d_data->level - 1 );
+
+        from /= bucketSize;
+        to /= bucketSize;
+    }
+
+    d_data->from = from;
+    d_data->to = to;
+}
+
 /*!
    Constructor
 
@@ -179,6 +1010,7 @@ QwtSyntheticPointData::QwtSyntheticPointData(
 void QwtSyntheticPointData::setSize( size_t size )
 {
     d_size = size;
+    incrementRevision();
 }
 
 /*!
@@ -199,6 +1031,7 @@ size_t QwtSyntheticPointData::size() const
 void QwtSyntheticPointData::setInterval( const QwtInterval &interval )
 {
     d_interval = interval.normalized();
+    incrementRevision();
 }
 
 /*!
@@ -223,9 +1056,17 @@ QwtInterval QwtSyntheticPointData::interval() const
 */
 void QwtSyntheticPointData::setRectOfInterest( const QRectF &rect )
 {
-    d_rectOfInterest = rect;
-    d_intervalOfInterest = QwtInterval(
+    const QwtInterval intervalOfInterest = QwtInterval(
         rect.left(), rect.right() ).normalized();
+
+    if ( !d_interval.isValid() && intervalOfInterest != d_intervalOfInterest )
+    {
+        // the x values depend on the interval of interest
+        incrementRevision();
+    }
+
+    d_rectOfInterest = rect;
+    d_intervalOfInterest = intervalOfInterest;
 }
 
 /*!
@@ -15,18 +15,31 @@
 
 /*!
   \brief Interface for iterating over two QVector<double> objects.
+
+  Samples can be appended, what extends the bounding rectangle 
+  by the new samples only. So autoscaling a growing series
+  doesn't need to iterate over all samples again.
 */
 class QWT_EXPORT QwtPointArrayData: public QwtSeriesData<QPointF>
 {
 public:
+    QwtPointArrayData();
     QwtPointArrayData( const QVector<double> &x, const QVector<double> &y );
     QwtPointArrayData( const double *x, const double *y, size_t size );
 
+    void append( double x, double y );
+    void append( const double *x, const double *y, size_t size );
+
+    void clear();
+
     virtual QRectF boundingRect() const;
 
     virtual size_t size() const;
     virtual QPointF sample( size_t i ) const;
 
+    virtual void copySamples( size_t from, 
+        size_t numSamples, QPointF *samples ) const;
+
     const QVector<double> &xData() const;
     const QVector<double> &yData() const;
 
@@ -37,16 +50,25 @@ private:
 
 /*!
   \brief Data class containing two pointers to memory blocks of doubles.
+
+  For memory blocks, that are filled in place, the number of 
+  valid samples can be increased by setSize(), what extends the 
+  bounding rectangle by the new samples only.
  */
 class QWT_EXPORT QwtCPointerData: public QwtSeriesData<QPointF>
 {
 public:
     QwtCPointerData( const double *x, const double *y, size_t size );
 
+    void setSize( size_t size );
+
     virtual QRectF boundingRect() const;
     virtual size_t size() const;
     virtual QPointF sample( size_t i ) const;
 
+    virtual void copySamples( size_t from, 
+        size_t numSamples, QPointF *samples ) const;
+
     const double *xData() const;
     const double *yData() const;
 
@@ -56,6 +78,80 @@ private:
     size_t d_size;
 };
 
+/*!
+  \brief Point data organized as a min/max pyramid
+
+  QwtPointPyramidData is intended for displaying series with millions
+  of points with x values in increasing order ( f.e. time series ).
+
+  Beside the samples ( level 0 ) it builds a hierarchy of levels,
+  where level k >= 1 divides the series into buckets of 8 * 2^( k - 1 )
+  samples: 8 samples for level 1, 16 for level 2 ... For each bucket
+  the first and the last sample and the samples with the minimum
+  and maximum y values are stored.
+
+  setRectOfInterest() selects the level, where the number of buckets 
+  in the visible x interval does not exceed resolution(). As these 4 points
+  of each bucket are sufficient to display the envelope of the samples
+  and to connect it to the neighboured buckets without gaps,
+  size() and sample() return the points of the buckets in the
+  visible interval only. In situations, where the number of
+  visible samples is small enough, the samples itself are returned.
+
+  So the costs for panning and zooming depend on the resolution of 
+  the canvas only and not on the number of samples.
+
+  New samples can be appended without having to rebuild the complete
+  pyramid.
+
+  \note The x values of the samples need to be in increasing order
+  \sa QwtPlotCurve::setData(), QwtPlotCurve::FilterPointsAggressive
+ */
+class QWT_EXPORT QwtPointPyramidData: public QwtSeriesData<QPointF>
+{
+public:
+    QwtPointPyramidData();
+    QwtPointPyramidData( const QVector<double> &x, const QVector<double> &y );
+    QwtPointPyramidData( const double *x, const double *y, size_t size );
+
+    virtual ~QwtPointPyramidData();
+
+    void setSamples( const QVector<double> &x, const QVector<double> &y );
+
+    void append( double x, double y );
+    void append( const double *x, const double *y, size_t size );
+
+    void clear();
+
+    void setResolution( int numBuckets );
+    int resolution() const;
+
+    int levelCount() const;
+    int currentLevel() const;
+
+    size_t numSamples() const;
+    QPointF rawSample( size_t i ) const;
+
+    virtual QRectF boundingRect() const;
+
+    virtual size_t size() const;
+    virtual QPointF sample( size_t i ) const;
+
+    virtual void copySamples( size_t from, 
+        size_t numSamples, QPointF *samples ) const;
+
+    virtual void setRectOfInterest( const QRectF & );
+    QRectF rectOfInterest() const;
+
+private:
+    void updateLevels( int from );
+    void updateView();
+    void selectView();
+
+    class PrivateData;
+    PrivateData *d_data;
+};
+
 /*!
   \brief Synthetic point data
 
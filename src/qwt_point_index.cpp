@@ -0,0 +1,441 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_point_index.h"
+#include "qwt_scale_map.h"
+#include "qwt_math.h"
+#include <qmath.h>
+#include <qnumeric.h>
+#include <algorithm>
+
+// number of samples of a chunk for series with increasing x values
+static const int qwtChunkSize = 64;
+
+// the maximum distance of the brute force algorithm, that
+// has been used before
+static const double qwtMaxDistance = 1.0e10;
+
+class QwtIndexChunk
+{
+public:
+    double minX;
+    double maxX;
+    double minY;
+    double maxY;
+};
+
+class QwtIndexPoint
+{
+public:
+    QPointF pos;
+    int index;
+};
+
+class QwtIndexLessX
+{
+public:
+    inline bool operator()(
+        const QwtIndexPoint &p1, const QwtIndexPoint &p2 ) const
+    {
+        return p1.pos.x() < p2.pos.x();
+    }
+};
+
+class QwtIndexLessY
+{
+public:
+    inline bool operator()(
+        const QwtIndexPoint &p1, const QwtIndexPoint &p2 ) const
+    {
+        return p1.pos.y() < p2.pos.y();
+    }
+};
+
+/*
+  An implicit k-d tree: the median of a range is the node, the
+  lower half is the left, the upper half the right subtree.
+ */
+static void qwtBuildTree( QwtIndexPoint *points,
+    int from, int to, bool splitX )
+{
+    if ( to - from <= 1 )
+        return;
+
+    const int mid = from + ( to - from ) / 2;
+
+    if ( splitX )
+    {
+        std::nth_element( points + from, points + mid,
+            points + to, QwtIndexLessX() );
+    }
+    else
+    {
+        std::nth_element( points + from, points + mid,
+            points + to, QwtIndexLessY() );
+    }
+
+    qwtBuildTree( points, from, mid, !splitX );
+    qwtBuildTree( points, mid + 1, to, !splitX );
+}
+
+static inline double qwtDistance( double value, double min, double max )
+{
+    if ( min > max )
+        qSwap( min, max );
+
+    if ( value < min )
+        return min - value;
+
+    if ( value > max )
+        return value - max;
+
+    return 0.0;
+}
+
+class QwtIndexSearch
+{
+public:
+    QwtIndexSearch( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+            const QPointF &pos ):
+        xMap( xMap ),
+        yMap( yMap ),
+        pos( pos ),
+        scalePos( QwtScaleMap::invTransform( xMap, yMap, pos ) ),
+        distance( qwtMaxDistance ),
+        index( -1 )
+    {
+        xInverted = ( xMap.p2() - xMap.p1() ) * ( xMap.s2() - xMap.s1() ) < 0.0;
+        yInverted = ( yMap.p2() - yMap.p1() ) * ( yMap.s2() - yMap.s1() ) < 0.0;
+    }
+
+    inline void check( const QPointF &sample, int sampleIndex )
+    {
+        const double dx = xMap.transform( sample.x() ) - pos.x();
+        const double dy = yMap.transform( sample.y() ) - pos.y();
+
+        const double d = qwtSqr( dx ) + qwtSqr( dy );
+
+        // in case of equal distances the first sample wins
+        if ( d < distance || ( d == distance && sampleIndex < index ) )
+        {
+            distance = d;
+            index = sampleIndex;
+        }
+    }
+
+    void searchTree( const QwtIndexPoint *points,
+        int from, int to, bool splitX )
+    {
+        if ( from >= to )
+            return;
+
+        const int mid = from + ( to - from ) / 2;
+        const QwtIndexPoint &node = points[mid];
+
+        check( node.pos, node.index );
+
+        // deciding the side in paint device coordinates avoids
+        // trouble with positions, that can't be inverted ( log scales )
+
+        bool lower;
+        double delta;
+
+        if ( splitX )
+        {
+            delta = xMap.transform( node.pos.x() ) - pos.x();
+            lower = ( delta > 0.0 ) != xInverted;
+        }
+        else
+        {
+            delta = yMap.transform( node.pos.y() ) - pos.y();
+            lower = ( delta > 0.0 ) != yInverted;
+        }
+
+        // the points on the other side of the node are at least
+        // delta pixels away
+
+        if ( lower )
+        {
+            searchTree( points, from, mid, !splitX );
+            if ( qwtSqr( delta ) <= distance )
+                searchTree( points, mid + 1, to, !splitX );
+        }
+        else
+        {
+            searchTree( points, mid + 1, to, !splitX );
+            if ( qwtSqr( delta ) <= distance )
+                searchTree( points, from, mid, !splitX );
+        }
+    }
+
+    void searchChunks( const QwtSeriesData<QPointF> *series,
+        const QVector<QwtIndexChunk> &chunks )
+    {
+        const QwtIndexChunk *c = chunks.constData();
+        const int numChunks = chunks.size();
+
+        // binary search for the first chunk with x values >= pos
+
+        int first = 0;
+        int n = numChunks;
+
+        while ( n > 0 )
+        {
+            const int half = n >> 1;
+            const int mid = first + half;
+
+            if ( c[mid].maxX < scalePos.x() )
+            {
+                first = mid + 1;
+                n -= half + 1;
+            }
+            else
+            {
+                n = half;
+            }
+        }
+
+        const int numSamples = static_cast<int>( series->size() );
+
+        for ( int i = first; i < numChunks; i++ )
+        {
+            if ( !searchChunk( series, c[i], i, numSamples ) )
+                break;
+        }
+
+        for ( int i = first - 1; i >= 0; i-- )
+        {
+            if ( !searchChunk( series, c[i], i, numSamples ) )
+                break;
+        }
+    }
+
+    const QwtScaleMap &xMap;
+    const QwtScaleMap &yMap;
+
+    const QPointF pos;
+    const QPointF scalePos;
+
+    double distance;
+    int index;
+
+private:
+    bool xInverted;
+    bool yInverted;
+
+    bool searchChunk( const QwtSeriesData<QPointF> *series,
+        const QwtIndexChunk &chunk, int chunkIndex, int numSamples )
+    {
+        const double dx = qwtDistance( pos.x(),
+            xMap.transform( chunk.minX ), xMap.transform( chunk.maxX ) );
+
+        // all following chunks are even more far away
+        if ( qwtSqr( dx ) > distance )
+            return false;
+
+        const double dy = qwtDistance( pos.y(),
+            yMap.transform( chunk.minY ), yMap.transform( chunk.maxY ) );
+
+        if ( qwtSqr( dx ) + qwtSqr( dy ) > distance )
+            return true;
+
+        const int from = chunkIndex * qwtChunkSize;
+        const int count = qMin( qwtChunkSize, numSamples - from );
+
+        QPointF samples[qwtChunkSize];
+        series->copySamples( from, count, samples );
+
+        for ( int i = 0; i < count; i++ )
+            check( samples[i], from + i );
+
+        return true;
+    }
+};
+
+class QwtPointIndex::PrivateData
+{
+public:
+    PrivateData():
+        isValid( false ),
+        series( NULL ),
+        size( 0 ),
+        revision( 0 ),
+        monotonic( false )
+    {
+    }
+
+    bool isValid;
+
+    const QwtSeriesData<QPointF> *series;
+    size_t size;
+    uint revision;
+
+    bool monotonic;
+
+    QVector<QwtIndexChunk> chunks; // monotonic
+    QVector<QwtIndexPoint> points; // k-d tree
+};
+
+//! Constructor
+QwtPointIndex::QwtPointIndex()
+{
+    d_data = new PrivateData();
+}
+
+//! Destructor
+QwtPointIndex::~QwtPointIndex()
+{
+    delete d_data;
+}
+
+/*!
+  \brief Invalidate the index
+
+  The index will be rebuilt, when closestPoint() is called
+  the next time.
+ */
+void QwtPointIndex::invalidate()
+{
+    d_data->isValid = false;
+    d_data->series = NULL;
+    d_data->size = 0;
+
+    d_data->chunks.clear();
+    d_data->points.clear();
+}
+
+/*!
+  Find the closest point of a series for a specific position
+
+  The index is built, when being called for the first time
+  or when the series, its size or its revision has changed.
+
+  \param series Series
+  \param xMap Maps x-values into pixel coordinates.
+  \param yMap Maps y-values into pixel coordinates.
+  \param pos Position in pixel coordinates
+  \param dist If dist != NULL, closestPoint() returns the distance between
+              the position and the closest point
+
+  \return Index of the closest point, or -1 if none can be found
+          ( f.e when the series has no points )
+ */
+int QwtPointIndex::closestPoint( const QwtSeriesData<QPointF> *series,
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QPointF &pos, double *dist ) const
+{
+    if ( series == NULL || series->size() <= 0 )
+        return -1;
+
+    if ( !d_data->isValid || series != d_data->series
+        || series->size() != d_data->size
+        || series->revision() != d_data->revision )
+    {
+        build( series );
+    }
+
+    QwtIndexSearch search( xMap, yMap, pos );
+
+    if ( d_data->monotonic )
+    {
+        search.searchChunks( series, d_data->chunks );
+    }
+    else
+    {
+        search.searchTree( d_data->points.constData(),
+            0, d_data->points.size(), true );
+    }
+
+    if ( dist )
+        *dist = qSqrt( search.distance );
+
+    return search.index;
+}
+
+void QwtPointIndex::build( const QwtSeriesData<QPointF> *series ) const
+{
+    d_data->chunks.clear();
+    d_data->points.clear();
+
+    d_data->series = series;
+    d_data->size = series->size();
+    d_data->revision = series->revision();
+    d_data->monotonic = true;
+
+    const int numSamples = static_cast<int>( d_data->size );
+
+    QwtSeriesReader<QPointF> reader( series, 0, numSamples - 1 );
+
+    QVector<QwtIndexChunk> chunks(
+        ( numSamples + qwtChunkSize - 1 ) / qwtChunkSize );
+
+    QwtIndexChunk *c = chunks.data();
+
+    double x0 = 0.0;
+    for ( int i = 0; i < numSamples; i++ )
+    {
+        const QPointF &sample = reader.sample( i );
+
+        // also fails for NaN values
+        if ( i > 0 && !( sample.x() >= x0 ) )
+        {
+            d_data->monotonic = false;
+            break;
+        }
+
+        x0 = sample.x();
+
+        QwtIndexChunk &chunk = c[ i / qwtChunkSize ];
+        if ( i % qwtChunkSize == 0 )
+        {
+            chunk.minX = chunk.maxX = sample.x();
+            chunk.minY = chunk.maxY = sample.y();
+        }
+        else
+        {
+            chunk.maxX = sample.x();
+
+            if ( sample.y() < chunk.minY )
+                chunk.minY = sample.y();
+            else if ( sample.y() > chunk.maxY )
+                chunk.maxY = sample.y();
+        }
+    }
+
+    if ( d_data->monotonic )
+    {
+        d_data->chunks = chunks;
+    }
+    else
+    {
+        chunks.clear();
+
+        d_data->points.reserve( numSamples );
+
+        for ( int i = 0; i < numSamples; i++ )
+        {
+            const QPointF &sample = reader.sample( i );
+
+            // NaN values would break the ordering of the tree
+            if ( qIsNaN( sample.x() ) || qIsNaN( sample.y() ) )
+                continue;
+
+            QwtIndexPoint point;
+            point.pos = sample;
+            point.index = i;
+
+            d_data->points += point;
+        }
+
+        qwtBuildTree( d_data->points.data(),
+            0, d_data->points.size(), true );
+    }
+
+    d_data->isValid = true;
+}
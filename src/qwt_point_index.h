@@ -0,0 +1,69 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_POINT_INDEX_H
+#define QWT_POINT_INDEX_H
+
+#include "qwt_global.h"
+#include "qwt_series_data.h"
+
+class QwtScaleMap;
+
+/*!
+  \brief A spatial index for finding the closest point of a series
+
+  QwtPointIndex is built lazily from a series, when closestPoint() is
+  called for the first time. For series with increasing x values
+  it consists of the bounding rectangles of small chunks of samples,
+  that are found by a binary search. For all other series a k-d tree
+  of the samples is built.
+
+  As both structures are organized in scale coordinates they can
+  be used for any monotonic scale maps, so that the index
+  remains valid, when zooming or panning.
+
+  The k-d tree stores the position and the index of each sample,
+  what costs 24 bytes per sample - compared to the 16 bytes of a
+  QPointF sample. The chunks of series with increasing x values
+  cost 32 bytes for 64 samples.
+
+  The index is rebuilt, when the series, its size or its
+  QwtSeriesData::revision() has changed. The series data classes of Qwt
+  increment the revision, whenever their samples are modified - this
+  includes series, that return different samples depending on the
+  rectangle of interest, like QwtPointPyramidData, even when the
+  number of samples doesn't change. Samples, that are modified in place
+  by the application, need to be announced by
+  QwtSeriesData::incrementRevision().
+
+  \sa QwtPlotCurve::setPointIndexEnabled(), QwtPlotCurve::closestPoint()
+*/
+class QWT_EXPORT QwtPointIndex
+{
+public:
+    QwtPointIndex();
+    ~QwtPointIndex();
+
+    void invalidate();
+
+    int closestPoint( const QwtSeriesData<QPointF> *series,
+        const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QPointF &pos, double *dist = NULL ) const;
+
+private:
+    QwtPointIndex( const QwtPointIndex & );
+    QwtPointIndex &operator=( const QwtPointIndex & );
+
+    void build( const QwtSeriesData<QPointF> * ) const;
+
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
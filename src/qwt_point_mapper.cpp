@@ -14,6 +14,7 @@
 #include <qimage.h>
 #include <qpen.h>
 #include <qpainter.h>
+#include <qmath.h>
 
 #if QT_VERSION >= 0x040400
 
@@ -23,12 +24,66 @@
 
 #if !defined(QT_NO_QFUTURE)
 #define QWT_USE_THREADS 0
+
+// chunks of a polyline are mapped into separate buffers
+#define QWT_USE_POLYLINE_THREADS 1
 #endif
 
 #endif
 
 static QRectF qwtInvalidRect( 0.0, 0.0, -1.0, -1.0 );
 
+// Reading the samples in chunks and translating them
+// into paint device coordinates using the batch 
+// transformations of QwtScaleMap
+
+class QwtMappedPointReader
+{
+public:
+    QwtMappedPointReader( 
+            const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+            const QwtSeriesData<QPointF> *series, int from, int to ):
+        d_xMap( xMap ),
+        d_yMap( yMap ),
+        d_series( series ),
+        d_to( to ),
+        d_first( from ),
+        d_count( 0 )
+    {
+    }
+
+    inline const QPointF &point( int index )
+    {
+        if ( index < d_first || index >= d_first + d_count )
+            load( index );
+
+        return d_points[ index - d_first ];
+    }
+
+private:
+    void load( int index )
+    {
+        d_first = index;
+        d_count = qBound( 1, d_to - index + 1, int( ChunkSize ) );
+
+        d_series->copySamples( d_first, d_count, d_points );
+        QwtScaleMap::transform( d_xMap, d_yMap, 
+            d_points, d_points, d_count );
+    }
+
+    enum { ChunkSize = 256 };
+
+    const QwtScaleMap &d_xMap;
+    const QwtScaleMap &d_yMap;
+    const QwtSeriesData<QPointF> *d_series;
+    const int d_to;
+
+    int d_first;
+    int d_count;
+
+    QPointF d_points[ChunkSize];
+};
+
 // Helper class to work around the 5 parameters
 // limitation of QtConcurrent::run()
 class QwtDotsCommand
@@ -53,12 +108,15 @@ static void qwtRenderDots(
     const int x0 = pos.x();
     const int y0 = pos.y();
 
+    QwtMappedPointReader reader( xMap, yMap,
+        command.series, command.from, command.to );
+
     for ( int i = command.from; i <= command.to; i++ )
     {
-        const QPointF sample = command.series->sample( i );
+        const QPointF &point = reader.point( i );
 
-        const int x = static_cast<int>( xMap.transform( sample.x() ) + 0.5 ) - x0;
-        const int y = static_cast<int>( yMap.transform( sample.y() ) + 0.5 ) - y0;
+        const int x = static_cast<int>( point.x() + 0.5 ) - x0;
+        const int y = static_cast<int>( point.y() + 0.5 ) - y0;
 
         if ( x >= 0 && x < w && y >= 0 && y < h )
             bits[ y * w + x ] = rgb;
@@ -118,6 +176,8 @@ static inline Polygon qwtToPoints(
     Polygon polyline( to - from + 1 );
     Point *points = polyline.data();
 
+    QwtMappedPointReader reader( xMap, yMap, series, from, to );
+
     int numPoints = 0;
 
     if ( boundingRect.isValid() )
@@ -128,10 +188,10 @@ static inline Polygon qwtToPoints(
 
         for ( int i = from; i <= to; i++ )
         {
-            const QPointF sample = series->sample( i );
+            const QPointF &point = reader.point( i );
 
-            const double x = xMap.transform( sample.x() );
-            const double y = yMap.transform( sample.y() );
+            const double x = point.x();
+            const double y = point.y();
 
             if ( boundingRect.contains( x, y ) )
             {
@@ -151,10 +211,10 @@ static inline Polygon qwtToPoints(
 
         for ( int i = from; i <= to; i++ )
         {
-            const QPointF sample = series->sample( i );
+            const QPointF &point = reader.point( i );
 
-            const double x = xMap.transform( sample.x() );
-            const double y = yMap.transform( sample.y() );
+            const double x = point.x();
+            const double y = point.y();
 
             points[ numPoints ].rx() = round( x );
             points[ numPoints ].ry() = round( y );
@@ -204,18 +264,19 @@ static inline Polygon qwtToPolylineFiltered(
     Polygon polyline( to - from + 1 );
     Point *points = polyline.data();
 
-    const QPointF sample0 = series->sample( from );
+    QwtMappedPointReader reader( xMap, yMap, series, from, to );
+
+    const QPointF point0 = reader.point( from );
 
-    points[0].rx() = round( xMap.transform( sample0.x() ) );
-    points[0].ry() = round( yMap.transform( sample0.y() ) );
+    points[0].rx() = round( point0.x() );
+    points[0].ry() = round( point0.y() );
 
     int pos = 0;
     for ( int i = from + 1; i <= to; i++ )
     {
-        const QPointF sample = series->sample( i );
+        const QPointF &point = reader.point( i );
 
-        const Point p( round( xMap.transform( sample.x() ) ),
-            round( yMap.transform( sample.y() ) ) );
+        const Point p( round( point.x() ), round( point.y() ) );
 
         if ( points[pos] != p )
             points[++pos] = p;
@@ -244,6 +305,154 @@ static inline QPolygonF qwtToPolylineFilteredF(
         xMap, yMap, series, from, to, round );
 } 
 
+// Mapping points with reducing all consecutive points, that are
+// mapped to the same pixel column, to the first, the minimum,
+// the maximum and the last point of the column
+
+template<class Point>
+class QwtPixelColumn
+{
+public:
+    inline void reset( int index, const Point &point )
+    {
+        firstIndex = minIndex = maxIndex = lastIndex = index;
+        first = min = max = last = point;
+    }
+
+    inline void add( int index, const Point &point )
+    {
+        if ( point.y() < min.y() )
+        {
+            min = point;
+            minIndex = index;
+        }
+        else if ( point.y() > max.y() )
+        {
+            max = point;
+            maxIndex = index;
+        }
+
+        last = point;
+        lastIndex = index;
+    }
+
+    template<class Polygon>
+    inline void appendTo( Polygon &polyline ) const
+    {
+        // the points have to be appended in the order of the series,
+        // otherwise the lines between the columns would be wrong
+
+        append( polyline, first );
+
+        if ( minIndex < maxIndex )
+        {
+            appendIntermediate( polyline, minIndex, min );
+            appendIntermediate( polyline, maxIndex, max );
+        }
+        else
+        {
+            appendIntermediate( polyline, maxIndex, max );
+            appendIntermediate( polyline, minIndex, min );
+        }
+
+        if ( lastIndex != firstIndex )
+            append( polyline, last );
+    }
+
+private:
+    template<class Polygon>
+    inline void appendIntermediate( Polygon &polyline,
+        int index, const Point &point ) const
+    {
+        if ( index != firstIndex && index != lastIndex )
+            append( polyline, point );
+    }
+
+    template<class Polygon>
+    static inline void append( Polygon &polyline, const Point &point )
+    {
+        if ( polyline.isEmpty() || polyline.last() != point )
+            polyline += point;
+    }
+
+    int firstIndex, minIndex, maxIndex, lastIndex;
+    Point first, min, max, last;
+};
+
+template<class Polygon, class Point, class Round>
+static inline Polygon qwtToPolylineFilteredMinMax( 
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series, 
+    int from, int to, Round round )
+{
+    // For each pixel column we need at most 4 points. As the series
+    // might have points outside of the paint interval we can't
+    // calculate the exact size in advance.
+
+    const int numColumns = qCeil( xMap.pDist() ) + 2;
+
+    Polygon polyline;
+    polyline.reserve( qMin( to - from + 1, 4 * numColumns ) );
+
+    QwtMappedPointReader reader( xMap, yMap, series, from, to );
+
+    const QPointF point0 = reader.point( from );
+
+    double x = point0.x();
+    double y = point0.y();
+
+    int columnX = qwtRoundValue( x );
+
+    QwtPixelColumn<Point> column;
+    column.reset( from, Point( round( x ), round( y ) ) );
+
+    for ( int i = from + 1; i <= to; i++ )
+    {
+        const QPointF &point = reader.point( i );
+
+        x = point.x();
+        y = point.y();
+
+        const Point p( round( x ), round( y ) );
+
+        const int pixelX = qwtRoundValue( x );
+        if ( pixelX == columnX )
+        {
+            column.add( i, p );
+        }
+        else
+        {
+            column.appendTo( polyline );
+
+            column.reset( i, p );
+            columnX = pixelX;
+        }
+    }
+
+    column.appendTo( polyline );
+
+    return polyline;
+}
+
+static inline QPolygon qwtToPolylineFilteredMinMaxI(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series,
+    int from, int to )
+{
+    return qwtToPolylineFilteredMinMax<QPolygon, QPoint>(
+        xMap, yMap, series, from, to, QwtRoundI() );
+}
+
+template<class Round>
+static inline QPolygonF qwtToPolylineFilteredMinMaxF(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series,
+    int from, int to, Round round )
+{
+    return qwtToPolylineFilteredMinMax<QPolygonF, QPointF>(
+        xMap, yMap, series, from, to, round );
+} 
+
 template<class Polygon, class Point>
 static inline Polygon qwtToPointsFiltered(
     const QRectF &boundingRect,
@@ -258,13 +467,15 @@ static inline Polygon qwtToPointsFiltered(
 
     QwtPixelMatrix pixelMatrix( boundingRect.toAlignedRect() );
 
+    QwtMappedPointReader reader( xMap, yMap, series, from, to );
+
     int numPoints = 0;
     for ( int i = from; i <= to; i++ )
     {
-        const QPointF sample = series->sample( i );
+        const QPointF &point = reader.point( i );
 
-        const int x = qwtRoundValue( xMap.transform( sample.x() ) );
-        const int y = qwtRoundValue( yMap.transform( sample.y() ) );
+        const int x = qwtRoundValue( point.x() );
+        const int y = qwtRoundValue( point.y() );
 
         if ( pixelMatrix.testAndSetPixel( x, y, true ) == false )
         {
@@ -297,6 +508,237 @@ static inline QPolygonF qwtToPointsFilteredF(
         boundingRect, xMap, yMap, series, from, to );
 }
 
+// Helper class to work around the 5 parameters
+// limitation of QtConcurrent::run()
+class QwtPolylineCommand
+{
+public:
+    const QwtSeriesData<QPointF> *series;
+
+    // the chunk to be mapped
+    int from;
+    int to;
+
+    // the complete range, that is mapped
+    int first;
+    int last;
+
+    QwtPointMapper::TransformationFlags flags;
+};
+
+static inline int qwtPixelColumn( const QwtScaleMap &xMap,
+    const QwtSeriesData<QPointF> *series, int index )
+{
+    return qwtRoundValue( xMap.transform( series->sample( index ).x() ) );
+}
+
+/*
+  When reducing the points of a pixel column to min/max the borders 
+  of the chunks need to be aligned to the columns. So a chunk skips
+  the leading points, that belong to the last column of the previous
+  chunk, while the previous chunk continues until the end of its
+  last column.
+ */
+static inline void qwtAlignToColumns( const QwtScaleMap &xMap,
+    const QwtPolylineCommand &command, int &from, int &to )
+{
+    const QwtSeriesData<QPointF> *series = command.series;
+
+    if ( from > command.first )
+    {
+        const int column = qwtPixelColumn( xMap, series, from - 1 );
+        while ( from <= to && qwtPixelColumn( xMap, series, from ) == column )
+            from++;
+    }
+
+    if ( to < command.last && from <= to )
+    {
+        const int column = qwtPixelColumn( xMap, series, to );
+        while ( to < command.last && 
+            qwtPixelColumn( xMap, series, to + 1 ) == column )
+        {
+            to++;
+        }
+    }
+}
+
+static QPolygonF qwtToPolylineF( 
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtPolylineCommand command )
+{
+    const QwtSeriesData<QPointF> *series = command.series;
+    const QwtPointMapper::TransformationFlags flags = command.flags;
+
+    int from = command.from;
+    int to = command.to;
+
+    QPolygonF polyline;
+
+    if ( flags & QwtPointMapper::WeedOutIntermediatePoints )
+    {
+        qwtAlignToColumns( xMap, command, from, to );
+        if ( from > to )
+            return polyline;
+
+        if ( flags & QwtPointMapper::RoundPoints )
+        {
+            polyline = qwtToPolylineFilteredMinMaxF( 
+                xMap, yMap, series, from, to, QwtRoundF() );
+        }
+        else
+        {
+            polyline = qwtToPolylineFilteredMinMaxF( 
+                xMap, yMap, series, from, to, QwtNoRoundF() );
+        }
+    }
+    else if ( flags & QwtPointMapper::WeedOutPoints )
+    {
+        if ( flags & QwtPointMapper::RoundPoints )
+        {
+            polyline = qwtToPolylineFilteredF( 
+                xMap, yMap, series, from, to, QwtRoundF() );
+        }
+        else
+        {
+            polyline = qwtToPolylineFilteredF( 
+                xMap, yMap, series, from, to, QwtNoRoundF() );
+        }
+    }
+    else
+    {
+        if ( flags & QwtPointMapper::RoundPoints )
+        {
+            polyline = qwtToPointsF( qwtInvalidRect, 
+                xMap, yMap, series, from, to, QwtRoundF() );
+        }
+        else
+        {
+            polyline = qwtToPointsF( qwtInvalidRect, 
+                xMap, yMap, series, from, to, QwtNoRoundF() );
+        }
+    }
+
+    return polyline;
+}
+
+static QPolygon qwtToPolylineI( 
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtPolylineCommand command )
+{
+    const QwtSeriesData<QPointF> *series = command.series;
+    const QwtPointMapper::TransformationFlags flags = command.flags;
+
+    int from = command.from;
+    int to = command.to;
+
+    QPolygon polyline;
+
+    if ( flags & QwtPointMapper::WeedOutIntermediatePoints )
+    {
+        qwtAlignToColumns( xMap, command, from, to );
+        if ( from > to )
+            return polyline;
+
+        polyline = qwtToPolylineFilteredMinMaxI( 
+            xMap, yMap, series, from, to );
+    }
+    else if ( flags & QwtPointMapper::WeedOutPoints )
+    {
+        polyline = qwtToPolylineFilteredI( 
+            xMap, yMap, series, from, to );
+    }
+    else
+    {
+        polyline = qwtToPointsI( 
+            qwtInvalidRect, xMap, yMap, series, from, to );
+    }
+
+    return polyline;
+}
+
+template<class Polygon>
+static inline void qwtAppendPolyline( Polygon &polyline, 
+    const Polygon &chunk, bool weedOut )
+{
+    int from = 0;
+
+    // the first point of a chunk might be a duplicate of the
+    // last point of the previous chunk
+
+    if ( weedOut && !polyline.isEmpty() && !chunk.isEmpty()
+        && polyline.last() == chunk.first() )
+    {
+        from = 1;
+    }
+
+    const int size0 = polyline.size();
+    polyline.resize( size0 + chunk.size() - from );
+
+    typename Polygon::value_type *points = polyline.data() + size0;
+    const typename Polygon::value_type *chunkPoints = chunk.constData();
+
+    for ( int i = from; i < chunk.size(); i++ )
+        *points++ = chunkPoints[i];
+}
+
+template<class Polygon>
+static Polygon qwtMapPolyline( 
+    Polygon ( *mapPolyline )( const QwtScaleMap &, 
+        const QwtScaleMap &, const QwtPolylineCommand ),
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtPolylineCommand &command, uint numThreads )
+{
+#if QWT_USE_POLYLINE_THREADS
+    if ( numThreads == 0 )
+        numThreads = QThread::idealThreadCount();
+
+    // for small series the overhead of the threads doesn't pay off
+    const int minChunkSize = 50000;
+
+    const int numPoints = command.to - command.from + 1;
+    numThreads = qMin( numThreads, uint( qMax( numPoints / minChunkSize, 1 ) ) );
+
+    if ( numThreads > 1 )
+    {
+        const int chunkSize = numPoints / numThreads;
+
+        QwtPolylineCommand chunkCommand = command;
+
+        QList< QFuture<Polygon> > futures;
+        for ( uint i = 0; i < numThreads - 1; i++ )
+        {
+            chunkCommand.from = command.from + i * chunkSize;
+            chunkCommand.to = chunkCommand.from + chunkSize - 1;
+
+            futures += QtConcurrent::run( 
+                mapPolyline, xMap, yMap, chunkCommand );
+        }
+
+        chunkCommand.from = command.from + ( numThreads - 1 ) * chunkSize;
+        chunkCommand.to = command.to;
+
+        const Polygon lastChunk = mapPolyline( xMap, yMap, chunkCommand );
+
+        const bool weedOut = command.flags & 
+            ( QwtPointMapper::WeedOutPoints 
+                | QwtPointMapper::WeedOutIntermediatePoints );
+
+        Polygon polyline;
+
+        for ( int i = 0; i < futures.size(); i++ )
+            qwtAppendPolyline( polyline, futures[i].result(), weedOut );
+
+        qwtAppendPolyline( polyline, lastChunk, weedOut );
+
+        return polyline;
+    }
+#else
+    Q_UNUSED( numThreads )
+#endif
+
+    return mapPolyline( xMap, yMap, command );
+}
+
 class QwtPointMapper::PrivateData
 {
 public:
@@ -395,6 +837,10 @@ QRectF QwtPointMapper::boundingRect() const
   When the WeedOutPoints flag is enabled consecutive points,
   that are mapped to the same position will be one point. 
 
+  When the WeedOutIntermediatePoints flag is enabled consecutive points,
+  that are mapped to the same pixel column are reduced to the
+  first, the minimum, the maximum and the last point of the column.
+
   When RoundPoints is set all points are rounded to integers
   but returned as PolygonF - what only makes sense
   when the further processing of the values need a QPolygonF.
@@ -404,43 +850,26 @@ QRectF QwtPointMapper::boundingRect() const
   \param series Series of points to be mapped
   \param from Index of the first point to be painted
   \param to Index of the last point to be painted
+  \param numThreads Number of threads to be used for mapping huge
+                    series. If numThreads is set to 0, the system 
+                    specific ideal thread count is used. The result is
+                    the same as when mapping the series in one thread.
 
   \return Translated polygon
 */
 QPolygonF QwtPointMapper::toPolygonF(
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
-    const QwtSeriesData<QPointF> *series, int from, int to ) const
+    const QwtSeriesData<QPointF> *series, int from, int to,
+    uint numThreads ) const
 {
-    QPolygonF polyline;
-
-    if ( d_data->flags & WeedOutPoints )
-    {
-        if ( d_data->flags & RoundPoints )
-        {
-            polyline = qwtToPolylineFilteredF( 
-                xMap, yMap, series, from, to, QwtRoundF() );
-        }
-        else
-        {
-            polyline = qwtToPolylineFilteredF( 
-                xMap, yMap, series, from, to, QwtNoRoundF() );
-        }
-    }
-    else
-    {
-        if ( d_data->flags & RoundPoints )
-        {
-            polyline = qwtToPointsF( qwtInvalidRect, 
-                xMap, yMap, series, from, to, QwtRoundF() );
-        }
-        else
-        {
-            polyline = qwtToPointsF( qwtInvalidRect, 
-                xMap, yMap, series, from, to, QwtNoRoundF() );
-        }
-    }
-
-    return polyline;
+    QwtPolylineCommand command;
+    command.series = series;
+    command.from = command.first = from;
+    command.to = command.last = to;
+    command.flags = d_data->flags;
+
+    return qwtMapPolyline<QPolygonF>( &qwtToPolylineF,
+        xMap, yMap, command, numThreads );
 }
 
 /*!
@@ -449,32 +878,35 @@ QPolygonF QwtPointMapper::toPolygonF(
   When the WeedOutPoints flag is enabled consecutive points,
   that are mapped to the same position will be one point. 
 
+  When the WeedOutIntermediatePoints flag is enabled consecutive points,
+  that are mapped to the same pixel column are reduced to the
+  first, the minimum, the maximum and the last point of the column.
+
   \param xMap x map
   \param yMap y map
   \param series Series of points to be mapped
   \param from Index of the first point to be painted
   \param to Index of the last point to be painted
+  \param numThreads Number of threads to be used for mapping huge
+                    series. If numThreads is set to 0, the system 
+                    specific ideal thread count is used. The result is
+                    the same as when mapping the series in one thread.
 
   \return Translated polygon
 */
 QPolygon QwtPointMapper::toPolygon(
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
-    const QwtSeriesData<QPointF> *series, int from, int to ) const
+    const QwtSeriesData<QPointF> *series, int from, int to,
+    uint numThreads ) const
 {
-    QPolygon polyline;
-
-    if ( d_data->flags & WeedOutPoints )
-    {
-        polyline = qwtToPolylineFilteredI( 
-            xMap, yMap, series, from, to );
-    }
-    else
-    {
-        polyline = qwtToPointsI( 
-            qwtInvalidRect, xMap, yMap, series, from, to );
-    }
-
-    return polyline;
+    QwtPolylineCommand command;
+    command.series = series;
+    command.from = command.first = from;
+    command.to = command.last = to;
+    command.flags = d_data->flags;
+
+    return qwtMapPolyline<QPolygon>( &qwtToPolylineI,
+        xMap, yMap, command, numThreads );
 }
 
 /*!
@@ -42,7 +42,26 @@ public:
           Try to remove points, that are translated to the
           same position.
          */
-        WeedOutPoints = 0x02
+        WeedOutPoints = 0x02,
+
+        /*!
+          An even more aggressive weeding algorithm, that can be used
+          for toPolygon() or toPolygonF().
+
+          A consecutive chunk of points being mapped to the same
+          x coordinate ( pixel column ) is reduced to 4 points:
+
+          - first point
+          - point with the minimum y coordinate
+          - point with the maximum y coordinate
+          - last point
+
+          As the lines connecting these points cover the same pixels
+          as the complete chunk the rendered result is the same, while
+          the number of points is limited to 4 times the width
+          of the visible area.
+         */
+        WeedOutIntermediatePoints = 0x04
     };
 
     /*!  
@@ -64,10 +83,12 @@ public:
     QRectF boundingRect() const;
 
     QPolygonF toPolygonF( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
-        const QwtSeriesData<QPointF> *series, int from, int to ) const;
+        const QwtSeriesData<QPointF> *series, int from, int to,
+        uint numThreads = 1 ) const;
 
     QPolygon toPolygon( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
-        const QwtSeriesData<QPointF> *series, int from, int to ) const;
+        const QwtSeriesData<QPointF> *series, int from, int to,
+        uint numThreads = 1 ) const;
 
     QPolygon toPoints( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
         const QwtSeriesData<QPointF> *series, int from, int to ) const;
@@ -10,6 +10,14 @@
 #include "qwt_raster_data.h"
 #include "qwt_point_3d.h"
 #include <qnumeric.h>
+#include <qalgorithms.h>
+#include <qhash.h>
+#include <algorithm>
+#if QT_VERSION >= 0x040400
+#include <qthread.h>
+#include <qfuture.h>
+#include <qtconcurrentrun.h>
+#endif
 
 class QwtRasterData::ContourPlane
 {
@@ -156,7 +164,8 @@ inline QPointF QwtRasterData::ContourPlane::intersection(
 }
 
 //! Constructor
-QwtRasterData::QwtRasterData()
+QwtRasterData::QwtRasterData():
+    d_revision( 0 )
 {
 }
 
@@ -176,6 +185,32 @@ QwtRasterData::~QwtRasterData()
 void QwtRasterData::setInterval( Qt::Axis axis, const QwtInterval &interval )
 {
     d_intervals[axis] = interval;
+    incrementRevision();
+}
+
+/*!
+   \return Revision of the data, that is incremented,
+           whenever the data has been modified
+   \sa incrementRevision()
+ */
+uint QwtRasterData::revision() const
+{
+    return d_revision;
+}
+
+/*!
+   \brief Announce a modification of the data
+
+   Invalidates all information, that has been cached for the
+   current data by the items displaying it. Derived classes
+   call it, whenever their values change. Applications, that modify
+   values behind the back of the data object, need to call it too.
+
+   \sa revision()
+ */
+void QwtRasterData::incrementRevision()
+{
+    d_revision++;
 }
 
 /*!
@@ -213,6 +248,40 @@ void QwtRasterData::discardRaster()
 {
 }
 
+/*!
+  \brief Announce the coordinates of a raster
+
+  After initRaster() QwtPlotSpectrogram and contourPolylines() pass
+  the coordinates of all columns and rows of the raster. The returned
+  object is passed to all following calls of rasterValues() for this
+  raster - usually from different threads in parallel - and deleted
+  by the caller, when the raster has been resampled.
+
+  Implementations can return an object derived from RasterCoordinates
+  carrying lookup tables ( f.e. the indices and interpolation weights
+  of a matrix ) for the complete raster. As each raster has its own
+  object, rasters of different images can be resampled concurrently.
+
+  The default implementation returns a plain RasterCoordinates object.
+
+  \param x Array of the x coordinates of the columns
+  \param numX Number of columns
+  \param y Array of the y coordinates of the rows
+  \param numY Number of rows
+
+  \return Coordinates of the raster, to be deleted by the caller
+
+  \note The arrays have to stay valid until the returned object
+        has been deleted.
+
+  \sa initRaster(), rasterValues()
+*/
+QwtRasterData::RasterCoordinates *QwtRasterData::initRasterCoordinates(
+    const double *x, int numX, const double *y, int numY ) const
+{
+    return new RasterCoordinates( x, numX, y, numY );
+}
+
 /*!
    \brief Pixel hint
 
@@ -245,6 +314,482 @@ QRectF QwtRasterData::pixelHint( const QRectF &area ) const
     return QRectF(); 
 }
 
+/*!
+   \brief Values of a raster
+
+   Fills values for all combinations of the x and y coordinates, where
+   values[ row * numX + col ] is the value at ( x[col], y[row] ).
+   So a row or a tile of an image can be resampled with one call.
+
+   The default implementation calls value() for each position.
+   Implementations, that have their values in memory, should
+   reimplement it with a tight loop, avoiding the virtual call per value.
+
+   \param x Array of x values in plot coordinates
+   \param numX Number of x values
+   \param y Array of y values in plot coordinates
+   \param numY Number of y values
+   \param values Buffer for at least numX * numY values
+
+   \sa value(), QwtPlotSpectrogram::renderTile()
+*/
+void QwtRasterData::values( const double *x, int numX,
+    const double *y, int numY, double *values ) const
+{
+    for ( int row = 0; row < numY; row++ )
+    {
+        const double ty = y[row];
+
+        for ( int col = 0; col < numX; col++ )
+            *values++ = value( x[col], ty );
+    }
+}
+
+/*!
+   \brief Values of a part of a raster
+
+   Fills values for the columns [col, col + numX[ and the rows
+   [row, row + numY[ of a raster, that has been returned from
+   initRasterCoordinates().
+
+   The default implementation calls values() with the coordinates
+   of the raster.
+
+   \param raster Raster returned from initRasterCoordinates()
+   \param col Index of the first column
+   \param numX Number of columns
+   \param row Index of the first row
+   \param numY Number of rows
+   \param values Buffer for at least numX * numY values
+
+   \note An implementation, that overrides rasterValues(), has to
+         accept all objects returned from its initRasterCoordinates().
+
+   \sa values(), initRasterCoordinates()
+*/
+void QwtRasterData::rasterValues( const RasterCoordinates *raster,
+    int col, int numX, int row, int numY, double *values ) const
+{
+    this->values( raster->x() + col, numX,
+        raster->y() + row, numY, values );
+}
+
+/*!
+  \brief Constructor
+
+  \param x Array of the x coordinates of the columns
+  \param numX Number of columns
+  \param y Array of the y coordinates of the rows
+  \param numY Number of rows
+*/
+QwtRasterData::RasterCoordinates::RasterCoordinates(
+        const double *x, int numX, const double *y, int numY ):
+    d_x( x ),
+    d_numX( numX ),
+    d_y( y ),
+    d_numY( numY )
+{
+}
+
+//! Destructor
+QwtRasterData::RasterCoordinates::~RasterCoordinates()
+{
+}
+
+/*
+  Resample rows of a raster - a function with a signature,
+  that can be passed to QtConcurrent::run()
+ */
+static void qwtRasterRows( const QwtRasterData *data,
+    const QwtRasterData::RasterCoordinates *coordinates,
+    int row, int numRows, double *values )
+{
+    data->rasterValues( coordinates, 0, coordinates->numX(),
+        row, numRows, values );
+}
+
+/*
+  A segment of a contour line. Its end points are identified by the
+  edge of the grid ( or the vertex for plateaus ), where they are located,
+  so that segments of neighboured cells can be joined by their keys.
+ */
+class QwtContourSegment
+{
+public:
+    qint64 key[2];
+    QPointF point[2];
+};
+
+/*
+  Values of the grid and the parameters for the marching squares
+  algorithm, shared by all threads
+ */
+class QwtContourGrid
+{
+public:
+    inline qint64 edgeKey( int col, int row, bool vertical ) const
+    {
+        return 2 * ( qint64( row ) * width + col ) + ( vertical ? 1 : 0 );
+    }
+
+    inline qint64 vertexKey( int col, int row ) const
+    {
+        return 2 * qint64( width ) * height + qint64( row ) * width + col;
+    }
+
+    inline bool isPlateau( int col, int row, double level ) const
+    {
+        if ( col < 0 || col >= width - 1 || row < 0 || row >= height - 1 )
+            return false;
+
+        const double *v0 = values + row * width + col;
+        const double *v1 = v0 + width;
+
+        return v0[0] == level && v0[1] == level
+            && v1[0] == level && v1[1] == level;
+    }
+
+    const double *values;
+    int width;
+    int height;
+
+    double x0;
+    double y0;
+    double dx;
+    double dy;
+
+    QVector<double> levels;
+
+    bool ignoreOnPlane;
+    bool ignoreOutOfRange;
+    QwtInterval range;
+};
+
+/*
+  Position and key of the intersection of a level with an edge of a cell.
+  The edges are 0: top, 1: right, 2: bottom, 3: left. The values of
+  an edge are always interpolated in the same direction, so that
+  neighboured cells calculate identical points.
+
+  Intersections on a vertex are identified by the vertex, so that
+  they are joined with the segments of all cells sharing it -
+  including the outlines of plateaus.
+ */
+static inline void qwtContourIntersection( const QwtContourGrid &grid,
+    int col, int row, const double z[4], int edge, double level,
+    qint64 &key, QPointF &pos )
+{
+    // vertices of the edges in the direction of the interpolation
+    static const int vertices[4][2] =
+        { { 0, 1 }, { 1, 2 }, { 3, 2 }, { 0, 3 } };
+
+    // positions of the vertices: top left, top right,
+    // bottom right, bottom left
+    static const int offsets[4][2] =
+        { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+
+    const int v1 = vertices[edge][0];
+    const int v2 = vertices[edge][1];
+
+    const double t = ( level - z[v1] ) / ( z[v2] - z[v1] );
+
+    const int c1 = col + offsets[v1][0];
+    const int r1 = row + offsets[v1][1];
+
+    if ( t <= 0.0 || t >= 1.0 )
+    {
+        const int v = ( t <= 0.0 ) ? v1 : v2;
+
+        const int c = col + offsets[v][0];
+        const int r = row + offsets[v][1];
+
+        key = grid.vertexKey( c, r );
+        pos.rx() = grid.x0 + c * grid.dx;
+        pos.ry() = grid.y0 + r * grid.dy;
+    }
+    else
+    {
+        const int c2 = col + offsets[v2][0];
+        const int r2 = row + offsets[v2][1];
+
+        key = grid.edgeKey( c1, r1, c1 == c2 );
+        pos.rx() = grid.x0 + ( c1 + ( c2 - c1 ) * t ) * grid.dx;
+        pos.ry() = grid.y0 + ( r1 + ( r2 - r1 ) * t ) * grid.dy;
+    }
+}
+
+static inline void qwtAppendContourSegment( const QwtContourGrid &grid,
+    int col, int row, const double z[4], int edge1, int edge2,
+    double level, QVector<QwtContourSegment> &segments )
+{
+    QwtContourSegment segment;
+
+    qwtContourIntersection( grid, col, row, z,
+        edge1, level, segment.key[0], segment.point[0] );
+    qwtContourIntersection( grid, col, row, z,
+        edge2, level, segment.key[1], segment.point[1] );
+
+    // both ends on the same vertex: the level only touches the cell
+    if ( segment.key[0] != segment.key[1] )
+        segments += segment;
+}
+
+/*
+  Outline of a cell, where all vertices are on the level. Only the sides
+  to cells, that are not on the level too, are part of the contour.
+ */
+static void qwtAppendPlateauSegments( const QwtContourGrid &grid,
+    int col, int row, double level, QVector<QwtContourSegment> &segments )
+{
+    // vertices of the sides: top, right, bottom, left
+    static const int offsets[5][2] =
+        { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { 0, 0 } };
+
+    // neighboured cells of the sides
+    static const int neighbours[4][2] =
+        { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+
+    for ( int side = 0; side < 4; side++ )
+    {
+        if ( grid.isPlateau( col + neighbours[side][0],
+            row + neighbours[side][1], level ) )
+        {
+            continue;
+        }
+
+        QwtContourSegment segment;
+
+        for ( int i = 0; i < 2; i++ )
+        {
+            const int c = col + offsets[side + i][0];
+            const int r = row + offsets[side + i][1];
+
+            segment.key[i] = grid.vertexKey( c, r );
+            segment.point[i] = QPointF(
+                grid.x0 + c * grid.dx, grid.y0 + r * grid.dy );
+        }
+
+        segments += segment;
+    }
+}
+
+/*
+  Marching squares for the cells of the rows [ fromRow, toRow [.
+  The segments are collected for each level separately.
+ */
+static void qwtContourBand( const QwtContourGrid *grid,
+    int fromRow, int toRow, QVector< QVector<QwtContourSegment> > *segments )
+{
+    // pairs of intersected edges for the 16 combinations of vertices
+    // above the level. 5 and 10 are saddles, that are resolved by the
+    // value in the center of the cell.
+    static const int cellEdges[16][2] =
+    {
+        { -1, -1 }, { 3, 0 }, { 0, 1 }, { 3, 1 },
+        { 1, 2 }, { -1, -1 }, { 0, 2 }, { 3, 2 },
+        { 2, 3 }, { 0, 2 }, { -1, -1 }, { 1, 2 },
+        { 3, 1 }, { 0, 1 }, { 3, 0 }, { -1, -1 }
+    };
+
+    const double *levelsBegin = grid->levels.constData();
+    const double *levelsEnd = levelsBegin + grid->levels.size();
+
+    for ( int row = fromRow; row < toRow; row++ )
+    {
+        const double *v0 = grid->values + row * grid->width;
+        const double *v1 = v0 + grid->width;
+
+        for ( int col = 0; col < grid->width - 1; col++ )
+        {
+            // top left, top right, bottom right, bottom left
+            const double z[4] = { v0[col], v0[col + 1], v1[col + 1], v1[col] };
+
+            double zMin = z[0];
+            double zMax = z[0];
+            double zSum = z[0];
+
+            for ( int i = 1; i < 4; i++ )
+            {
+                zSum += z[i];
+                if ( z[i] < zMin )
+                    zMin = z[i];
+                if ( z[i] > zMax )
+                    zMax = z[i];
+            }
+
+            if ( qIsNaN( zSum ) )
+            {
+                // one of the points is NaN
+                continue;
+            }
+
+            if ( grid->ignoreOutOfRange )
+            {
+                if ( !grid->range.contains( zMin ) ||
+                    !grid->range.contains( zMax ) )
+                {
+                    continue;
+                }
+            }
+
+            const double *l = qLowerBound( levelsBegin, levelsEnd, zMin );
+            for ( ; l != levelsEnd && *l <= zMax; ++l )
+            {
+                const double level = *l;
+                QVector<QwtContourSegment> &levelSegments =
+                    ( *segments )[ int( l - levelsBegin ) ];
+
+                if ( level == zMax )
+                {
+                    // no vertex is above the level
+                    if ( zMin == zMax && !grid->ignoreOnPlane )
+                    {
+                        qwtAppendPlateauSegments( *grid,
+                            col, row, level, levelSegments );
+                    }
+
+                    continue;
+                }
+
+                int index = 0;
+                for ( int i = 0; i < 4; i++ )
+                {
+                    if ( z[i] > level )
+                        index |= 1 << i;
+                }
+
+                if ( index == 5 || index == 10 )
+                {
+                    const bool centerAbove = 0.25 * zSum > level;
+
+                    if ( ( index == 5 ) == centerAbove )
+                    {
+                        qwtAppendContourSegment( *grid, col, row, z,
+                            0, 1, level, levelSegments );
+                        qwtAppendContourSegment( *grid, col, row, z,
+                            2, 3, level, levelSegments );
+                    }
+                    else
+                    {
+                        qwtAppendContourSegment( *grid, col, row, z,
+                            3, 0, level, levelSegments );
+                        qwtAppendContourSegment( *grid, col, row, z,
+                            1, 2, level, levelSegments );
+                    }
+                }
+                else
+                {
+                    qwtAppendContourSegment( *grid, col, row, z,
+                        cellEdges[index][0], cellEdges[index][1],
+                        level, levelSegments );
+                }
+            }
+        }
+    }
+}
+
+/*
+  Join the segments of all bands for one level into polylines.
+  An end point on an edge is shared by at most 2 segments. On a vertex
+  there might be more, where the ends are linked pairwise. So the
+  polylines can be found by walking along the links between the
+  end points.
+ */
+static QVector<QPolygonF> qwtJoinContourSegments(
+    const QVector< QVector< QVector<QwtContourSegment> > > *bands, int level )
+{
+    QVector<QwtContourSegment> segments;
+    for ( int i = 0; i < bands->size(); i++ )
+        segments += ( *bands )[i][level];
+
+    const int numSegments = segments.size();
+
+    // link from an end point ( 2 * segment + end ) to the connected one
+    QVector<int> links( 2 * numSegments, -1 );
+
+    QHash<qint64, int> openEnds;
+    openEnds.reserve( numSegments );
+
+    for ( int i = 0; i < 2 * numSegments; i++ )
+    {
+        const qint64 key = segments[i / 2].key[i % 2];
+
+        QHash<qint64, int>::iterator it = openEnds.find( key );
+        if ( it == openEnds.end() )
+        {
+            openEnds.insert( key, i );
+        }
+        else
+        {
+            links[i] = it.value();
+            links[it.value()] = i;
+            openEnds.erase( it );
+        }
+    }
+
+    QVector<bool> done( numSegments, false );
+    QVector<QPolygonF> polylines;
+
+    QPolygonF head;
+    for ( int i = 0; i < numSegments; i++ )
+    {
+        if ( done[i] )
+            continue;
+
+        done[i] = true;
+
+        QPolygonF polyline;
+        polyline += segments[i].point[0];
+        polyline += segments[i].point[1];
+
+        // forward from the second end point
+        bool isClosed = false;
+
+        int end = 2 * i + 1;
+        while ( links[end] >= 0 )
+        {
+            const int next = links[end];
+            if ( done[next / 2] )
+            {
+                // back at the first segment
+                isClosed = ( next == 2 * i );
+                break;
+            }
+
+            done[next / 2] = true;
+
+            end = next ^ 1;
+            polyline += segments[end / 2].point[end % 2];
+        }
+
+        if ( !isClosed )
+        {
+            // backward from the first end point
+            head.clear();
+
+            end = 2 * i;
+            while ( links[end] >= 0 && !done[links[end] / 2] )
+            {
+                const int next = links[end];
+                done[next / 2] = true;
+
+                end = next ^ 1;
+                head += segments[end / 2].point[end % 2];
+            }
+
+            if ( !head.isEmpty() )
+            {
+                std::reverse( head.begin(), head.end() );
+                polyline = head + polyline;
+            }
+        }
+
+        polylines += polyline;
+    }
+
+    return polylines;
+}
+
 /*!
    Calculate contour lines
 
@@ -257,6 +802,11 @@ QRectF QwtRasterData::pixelHint( const QRectF &area ) const
 
    An adaption of CONREC, a simple contouring algorithm.
    http://local.wasp.uwa.edu.au/~pbourke/papers/conrec/
+
+   \note QwtPlotSpectrogram uses contourLines() only, when the
+         QwtPlotSpectrogram::Conrec algorithm has been selected
+
+   \sa contourPolylines(), QwtPlotSpectrogram::setContourAlgorithm()
 */
 QwtRasterData::ContourLines QwtRasterData::contourLines(
     const QRectF &rect, const QSize &raster,
@@ -402,3 +952,191 @@ QwtRasterData::ContourLines QwtRasterData::contourLines(
 
     return contourLines;
 }
+
+/*!
+   Calculate contour lines as connected polylines
+
+   In opposite to contourLines(), the raster is sampled only once
+   by values() into a buffer, and the contour lines are found by
+   a marching squares algorithm in parallel threads, each of them working
+   on a band of rows. The segments of all cells are joined into polylines
+   for each level, so that they can be painted with a small number of
+   calls and proper joins between the segments.
+
+   \param rect Bounding rectangle for the contour lines
+   \param raster Number of data pixels of the raster data
+   \param levels List of limits, where to insert contour lines
+   \param flags Flags to customize the contouring algorithm
+   \param numThreads Number of threads. 0 means the system specific
+                     ideal thread count.
+
+   \return Calculated contour lines
+
+   \note With IgnoreAllVerticesOnLevel unset, areas, where all values
+         are on a level, are enclosed by their outline.
+
+   \sa contourLines(), values(), QwtPlotSpectrogram::renderContourPolylines()
+*/
+QwtRasterData::ContourPolylines QwtRasterData::contourPolylines(
+    const QRectF &rect, const QSize &raster,
+    const QList<double> &levels, ConrecFlags flags, int numThreads ) const
+{
+    ContourPolylines polylines;
+
+    if ( levels.size() == 0 || !rect.isValid() || !raster.isValid() )
+        return polylines;
+
+    const int width = raster.width();
+    const int height = raster.height();
+    if ( width < 2 || height < 2 )
+        return polylines;
+
+    QwtContourGrid grid;
+    grid.width = width;
+    grid.height = height;
+    grid.x0 = rect.x();
+    grid.y0 = rect.y();
+    grid.dx = rect.width() / width;
+    grid.dy = rect.height() / height;
+
+    grid.levels = levels.toVector();
+    qSort( grid.levels );
+    grid.levels.erase( std::unique( grid.levels.begin(), grid.levels.end() ),
+        grid.levels.end() );
+
+    grid.ignoreOnPlane = flags & QwtRasterData::IgnoreAllVerticesOnLevel;
+
+    grid.range = interval( Qt::ZAxis );
+    grid.ignoreOutOfRange = false;
+    if ( grid.range.isValid() )
+        grid.ignoreOutOfRange = flags & IgnoreOutOfRange;
+
+    QVector<double> xValues( width );
+    for ( int col = 0; col < width; col++ )
+        xValues[col] = grid.x0 + col * grid.dx;
+
+    QVector<double> yValues( height );
+    for ( int row = 0; row < height; row++ )
+        yValues[row] = grid.y0 + row * grid.dy;
+
+    QVector<double> buffer( width * height );
+    grid.values = buffer.constData();
+
+    const int numLevels = grid.levels.size();
+
+    QwtRasterData *that = const_cast<QwtRasterData *>( this );
+    that->initRaster( rect, raster );
+
+    RasterCoordinates *coordinates = initRasterCoordinates(
+        xValues.constData(), width, yValues.constData(), height );
+
+#if QT_VERSION >= 0x040400 && !defined(QT_NO_QFUTURE)
+    if ( numThreads <= 0 )
+        numThreads = QThread::idealThreadCount();
+
+    if ( numThreads <= 0 )
+        numThreads = 1;
+
+    // sampling the raster
+
+    numThreads = qMin( numThreads, height - 1 );
+
+    QList< QFuture<void> > futures;
+
+    const int numRows = height / numThreads;
+    for ( int i = 0; i < numThreads; i++ )
+    {
+        const int row = i * numRows;
+        const int n = ( i == numThreads - 1 ) ? height - row : numRows;
+
+        if ( i == numThreads - 1 )
+        {
+            qwtRasterRows( this, coordinates,
+                row, n, buffer.data() + row * width );
+        }
+        else
+        {
+            futures += QtConcurrent::run( qwtRasterRows, this, coordinates,
+                row, n, buffer.data() + row * width );
+        }
+    }
+
+    for ( int i = 0; i < futures.size(); i++ )
+        futures[i].waitForFinished();
+
+    futures.clear();
+
+    delete coordinates;
+    that->discardRaster();
+
+    // marching squares for bands of cells
+
+    const int numCellRows = ( height - 1 ) / numThreads;
+
+    QVector< QVector< QVector<QwtContourSegment> > > bands( numThreads );
+    for ( int i = 0; i < numThreads; i++ )
+    {
+        bands[i].resize( numLevels );
+
+        const int fromRow = i * numCellRows;
+        const int toRow = ( i == numThreads - 1 )
+            ? height - 1 : fromRow + numCellRows;
+
+        if ( i == numThreads - 1 )
+        {
+            qwtContourBand( &grid, fromRow, toRow, &bands[i] );
+        }
+        else
+        {
+            futures += QtConcurrent::run( qwtContourBand,
+                &grid, fromRow, toRow, &bands[i] );
+        }
+    }
+
+    for ( int i = 0; i < futures.size(); i++ )
+        futures[i].waitForFinished();
+
+    // joining the segments, level by level
+
+    QList< QFuture< QVector<QPolygonF> > > joinFutures;
+    if ( numThreads > 1 )
+    {
+        for ( int l = 0; l < numLevels; l++ )
+        {
+            joinFutures += QtConcurrent::run(
+                qwtJoinContourSegments, &bands, l );
+        }
+    }
+
+    for ( int l = 0; l < numLevels; l++ )
+    {
+        const QVector<QPolygonF> lines = ( numThreads > 1 )
+            ? joinFutures[l].result() : qwtJoinContourSegments( &bands, l );
+
+        if ( !lines.isEmpty() )
+            polylines.insert( grid.levels[l], lines );
+    }
+
+#else // QT_VERSION < 0x040400
+    Q_UNUSED( numThreads );
+
+    qwtRasterRows( this, coordinates, 0, height, buffer.data() );
+
+    delete coordinates;
+    that->discardRaster();
+
+    QVector< QVector< QVector<QwtContourSegment> > > bands( 1 );
+    bands[0].resize( numLevels );
+
+    qwtContourBand( &grid, 0, height - 1, &bands[0] );
+
+    for ( int l = 0; l < numLevels; l++ )
+    {
+        const QVector<QPolygonF> lines = qwtJoinContourSegments( &bands, l );
+        if ( !lines.isEmpty() )
+            polylines.insert( grid.levels[l], lines );
+    }
+#endif
+
+    return polylines;
+}
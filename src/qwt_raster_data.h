@@ -15,6 +15,7 @@
 #include <qmap.h>
 #include <qlist.h>
 #include <qpolygon.h>
+#include <qvector.h>
 
 class QwtScaleMap;
 
@@ -35,6 +36,9 @@ public:
     //! Contour lines
     typedef QMap<double, QPolygonF> ContourLines;
 
+    //! Contour lines as connected polylines for each level
+    typedef QMap<double, QVector<QPolygonF> > ContourPolylines;
+
     //! Flags to modify the contour algorithm
     enum ConrecFlag
     {
@@ -48,6 +52,8 @@ public:
     //! Flags to modify the contour algorithm
     typedef QFlags<ConrecFlag> ConrecFlags;
 
+    class RasterCoordinates;
+
     QwtRasterData();
     virtual ~QwtRasterData();
 
@@ -59,6 +65,9 @@ public:
     virtual void initRaster( const QRectF &, const QSize& raster );
     virtual void discardRaster();
 
+    virtual RasterCoordinates *initRasterCoordinates(
+        const double *x, int numX, const double *y, int numY ) const;
+
     /*!
        \return the value at a raster position
        \param x X value in plot coordinates
@@ -66,10 +75,23 @@ public:
     */
     virtual double value( double x, double y ) const = 0;
 
+    virtual void values( const double *x, int numX,
+        const double *y, int numY, double *values ) const;
+
+    virtual void rasterValues( const RasterCoordinates *,
+        int col, int numX, int row, int numY, double *values ) const;
+
     virtual ContourLines contourLines( const QRectF &rect,
         const QSize &raster, const QList<double> &levels,
         ConrecFlags ) const;
 
+    virtual ContourPolylines contourPolylines( const QRectF &rect,
+        const QSize &raster, const QList<double> &levels,
+        ConrecFlags, int numThreads = 0 ) const;
+
+    uint revision() const;
+    void incrementRevision();
+
     class Contour3DPoint;
     class ContourPlane;
 
@@ -79,8 +101,65 @@ private:
     QwtRasterData &operator=( const QwtRasterData & );
 
     QwtInterval d_intervals[3];
+    uint d_revision;
 };
 
+/*!
+  \brief Coordinates of the columns and rows of a raster
+
+  A RasterCoordinates object is created by
+  QwtRasterData::initRasterCoordinates() and passed to all calls of
+  QwtRasterData::rasterValues() for the same raster. Derived raster data
+  classes can return a derived object carrying precomputed lookup tables.
+
+  The object doesn't copy the coordinates: the arrays have to stay valid
+  until the object is deleted.
+*/
+class QWT_EXPORT QwtRasterData::RasterCoordinates
+{
+public:
+    RasterCoordinates( const double *x, int numX,
+        const double *y, int numY );
+    virtual ~RasterCoordinates();
+
+    const double *x() const;
+    int numX() const;
+
+    const double *y() const;
+    int numY() const;
+
+private:
+    const double *d_x;
+    int d_numX;
+
+    const double *d_y;
+    int d_numY;
+};
+
+//! \return Array of the x coordinates of the columns
+inline const double *QwtRasterData::RasterCoordinates::x() const
+{
+    return d_x;
+}
+
+//! \return Number of columns
+inline int QwtRasterData::RasterCoordinates::numX() const
+{
+    return d_numX;
+}
+
+//! \return Array of the y coordinates of the rows
+inline const double *QwtRasterData::RasterCoordinates::y() const
+{
+    return d_y;
+}
+
+//! \return Number of rows
+inline int QwtRasterData::RasterCoordinates::numY() const
+{
+    return d_numY;
+}
+
 /*!
    \return Bounding interval for a axis
    \sa setInterval
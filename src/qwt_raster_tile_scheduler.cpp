@@ -0,0 +1,385 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_raster_tile_scheduler.h"
+#include "qwt_system_clock.h"
+#include <qrect.h>
+#include <qlist.h>
+#include <qvector.h>
+#include <qatomic.h>
+#include <qmutex.h>
+#if QT_VERSION >= 0x040400
+#include <qthread.h>
+#include <qthreadpool.h>
+#include <qrunnable.h>
+#include <qsemaphore.h>
+#endif
+
+#if QT_VERSION >= 0x040400 && !defined(QT_NO_QFUTURE)
+#define QWT_TILE_THREADS 1
+#endif
+
+/*
+  The state of one call of QwtRasterTileScheduler::render(). The tiles
+  are numbered row by row and the threads take them by incrementing
+  an atomic counter.
+ */
+class QwtRasterTileJob
+{
+public:
+    QwtRasterTileJob( const QSize &imageSize, const QSize &tileSize,
+            QwtRasterTileScheduler::Task *task, int numThreads ):
+        busyTimes( numThreads, 0.0 ),
+        d_imageSize( imageSize ),
+        d_tileSize( tileSize ),
+        d_task( task ),
+        d_nextTile( 0 ),
+        d_cancelled( 0 )
+    {
+        d_numColumns = ( imageSize.width() + tileSize.width() - 1 )
+            / tileSize.width();
+
+        const int numRows = ( imageSize.height() + tileSize.height() - 1 )
+            / tileSize.height();
+
+        numTiles = d_numColumns * numRows;
+    }
+
+    // render tiles, until all tiles have been taken
+    void work( int worker )
+    {
+        QwtSystemClock clock;
+        clock.start();
+
+        while ( d_cancelled.fetchAndAddRelaxed( 0 ) == 0 )
+        {
+            const int index = d_nextTile.fetchAndAddRelaxed( 1 );
+            if ( index >= numTiles )
+                break;
+
+            d_task->renderTile( tileRect( index ) );
+        }
+
+        busyTimes[ worker ] = clock.elapsed();
+    }
+
+    void cancel()
+    {
+        d_cancelled.fetchAndStoreRelaxed( 1 );
+    }
+
+    bool isCancelled()
+    {
+        return d_cancelled.fetchAndAddRelaxed( 0 ) != 0;
+    }
+
+    int numTiles;
+
+    // written by each worker before it finishes
+    QVector<double> busyTimes;
+
+private:
+    QRect tileRect( int index ) const
+    {
+        const int row = index / d_numColumns;
+        const int col = index % d_numColumns;
+
+        const QRect rect( col * d_tileSize.width(), row * d_tileSize.height(),
+            d_tileSize.width(), d_tileSize.height() );
+
+        return rect & QRect( QPoint( 0, 0 ), d_imageSize );
+    }
+
+    const QSize d_imageSize;
+    const QSize d_tileSize;
+    QwtRasterTileScheduler::Task *d_task;
+
+    int d_numColumns;
+
+    QAtomicInt d_nextTile;
+    QAtomicInt d_cancelled;
+};
+
+#if QWT_TILE_THREADS
+
+class QwtRasterTileWorker: public QRunnable
+{
+public:
+    QwtRasterTileWorker( QwtRasterTileJob *job, int worker,
+            QSemaphore *finished ):
+        d_job( job ),
+        d_worker( worker ),
+        d_finished( finished )
+    {
+        setAutoDelete( true );
+    }
+
+    virtual void run()
+    {
+        d_job->work( d_worker );
+        d_finished->release();
+    }
+
+private:
+    QwtRasterTileJob *d_job;
+    int d_worker;
+    QSemaphore *d_finished;
+};
+
+#endif
+
+//! Destructor
+QwtRasterTileScheduler::Task::~Task()
+{
+}
+
+//! Constructor, initializing all values with 0
+QwtRasterTileScheduler::Statistics::Statistics():
+    numTiles( 0 ),
+    numThreads( 0 ),
+    wallTime( 0.0 ),
+    busyTime( 0.0 ),
+    maxBusyTime( 0.0 )
+{
+}
+
+/*!
+  \brief Load imbalance
+
+  \return Ratio between the busy time of the thread, that
+          was busy for the longest time, and the average busy time.
+          1.0 means, that all threads were busy for the same time.
+ */
+double QwtRasterTileScheduler::Statistics::imbalance() const
+{
+    if ( numThreads <= 0 || busyTime <= 0.0 )
+        return 1.0;
+
+    return maxBusyTime / ( busyTime / numThreads );
+}
+
+class QwtRasterTileScheduler::PrivateData
+{
+public:
+    PrivateData():
+        threadPool( NULL ),
+        maxThreadCount( 0 ),
+        tileSize( 256, 16 )
+    {
+    }
+
+    QThreadPool *threadPool;
+    int maxThreadCount;
+    QSize tileSize;
+
+    // guards jobs and statistics
+    QMutex mutex;
+
+    QList<QwtRasterTileJob *> jobs;
+    QwtRasterTileScheduler::Statistics statistics;
+};
+
+//! Constructor
+QwtRasterTileScheduler::QwtRasterTileScheduler()
+{
+    d_data = new PrivateData();
+}
+
+//! Destructor
+QwtRasterTileScheduler::~QwtRasterTileScheduler()
+{
+    delete d_data;
+}
+
+/*!
+  \brief Set the thread pool for the threads, that render tiles
+
+  \param threadPool Thread pool. NULL means QThreadPool::globalInstance().
+  \note The pool needs to live as long as the scheduler
+  \sa threadPool()
+ */
+void QwtRasterTileScheduler::setThreadPool( QThreadPool *threadPool )
+{
+    d_data->threadPool = threadPool;
+}
+
+/*!
+  \return Thread pool for the threads, that render tiles
+  \sa setThreadPool()
+ */
+QThreadPool *QwtRasterTileScheduler::threadPool() const
+{
+#if QWT_TILE_THREADS
+    if ( d_data->threadPool == NULL )
+        return QThreadPool::globalInstance();
+#endif
+
+    return d_data->threadPool;
+}
+
+/*!
+  \brief Limit the number of threads
+
+  \param count Maximum number of threads, including the calling thread.
+               0 means QThread::idealThreadCount().
+
+  \sa maxThreadCount(), QwtPlotItem::setRenderThreadCount()
+ */
+void QwtRasterTileScheduler::setMaxThreadCount( int count )
+{
+    d_data->maxThreadCount = qMax( count, 0 );
+}
+
+/*!
+  \return Maximum number of threads
+  \sa setMaxThreadCount()
+ */
+int QwtRasterTileScheduler::maxThreadCount() const
+{
+    return d_data->maxThreadCount;
+}
+
+/*!
+  \brief Set the size of the tiles
+
+  Smaller tiles balance the load better, but increase the overhead
+  for each tile. The default size is 256x16 pixels.
+
+  \param size Size of a tile in pixels
+  \sa tileSize()
+ */
+void QwtRasterTileScheduler::setTileSize( const QSize &size )
+{
+    d_data->tileSize = size.expandedTo( QSize( 1, 1 ) );
+}
+
+/*!
+  \return Size of the tiles in pixels
+  \sa setTileSize()
+ */
+QSize QwtRasterTileScheduler::tileSize() const
+{
+    return d_data->tileSize;
+}
+
+/*!
+  \brief Render all tiles of an image
+
+  Returns, when all tiles have been rendered or the job has been
+  cancelled.
+
+  \param imageSize Size of the image
+  \param task Task, that renders the tiles
+  \param numThreads Number of threads, including the calling thread.
+                    0 means maxThreadCount().
+
+  \return false, when rendering has been cancelled
+  \sa cancel(), statistics()
+ */
+bool QwtRasterTileScheduler::render( const QSize &imageSize,
+    Task *task, int numThreads )
+{
+    if ( imageSize.isEmpty() || task == NULL )
+        return true;
+
+    QwtSystemClock clock;
+    clock.start();
+
+    if ( numThreads <= 0 )
+        numThreads = d_data->maxThreadCount;
+
+#if QWT_TILE_THREADS
+    if ( numThreads <= 0 )
+        numThreads = QThread::idealThreadCount();
+#endif
+
+    if ( numThreads <= 0 )
+        numThreads = 1;
+
+    QwtRasterTileJob job( imageSize, d_data->tileSize, task, numThreads );
+    numThreads = qMin( numThreads, job.numTiles );
+
+    d_data->mutex.lock();
+    d_data->jobs += &job;
+    d_data->mutex.unlock();
+
+    int numWorkers = 1;
+
+#if QWT_TILE_THREADS
+    QSemaphore finished;
+
+    QThreadPool *pool = threadPool();
+    for ( int i = 1; i < numThreads; i++ )
+    {
+        // waiting for a busy pool might end in a dead lock,
+        // when render() is called from a thread of the pool
+        QwtRasterTileWorker *worker =
+            new QwtRasterTileWorker( &job, i, &finished );
+
+        if ( !pool->tryStart( worker ) )
+        {
+            delete worker;
+            break;
+        }
+
+        numWorkers++;
+    }
+#endif
+
+    job.work( 0 );
+
+#if QWT_TILE_THREADS
+    finished.acquire( numWorkers - 1 );
+#endif
+
+    Statistics statistics;
+    statistics.numTiles = job.numTiles;
+    statistics.numThreads = numWorkers;
+    statistics.wallTime = clock.elapsed();
+
+    for ( int i = 0; i < numWorkers; i++ )
+    {
+        statistics.busyTime += job.busyTimes[i];
+        statistics.maxBusyTime = qMax( statistics.maxBusyTime,
+            job.busyTimes[i] );
+    }
+
+    QMutexLocker locker( &d_data->mutex );
+
+    d_data->jobs.removeAll( &job );
+    d_data->statistics = statistics;
+
+    return !job.isCancelled();
+}
+
+/*!
+  \brief Cancel rendering
+
+  All calls of render(), that are running in other threads, return
+  as soon as the tiles, that are in progress, are completed.
+
+  \sa render()
+ */
+void QwtRasterTileScheduler::cancel()
+{
+    QMutexLocker locker( &d_data->mutex );
+
+    for ( int i = 0; i < d_data->jobs.size(); i++ )
+        d_data->jobs[i]->cancel();
+}
+
+/*!
+  \return Statistics of the image, that has been completed last
+  \sa render()
+ */
+QwtRasterTileScheduler::Statistics QwtRasterTileScheduler::statistics() const
+{
+    QMutexLocker locker( &d_data->mutex );
+    return d_data->statistics;
+}
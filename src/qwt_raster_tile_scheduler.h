@@ -0,0 +1,107 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_RASTER_TILE_SCHEDULER_H
+#define QWT_RASTER_TILE_SCHEDULER_H 1
+
+#include "qwt_global.h"
+#include <qsize.h>
+
+class QRect;
+class QThreadPool;
+
+/*!
+  \brief Render an image in small tiles by a number of threads
+
+  The image is divided into tiles of tileSize(). Each thread takes
+  the next tile, that has not been rendered yet, as soon as it has
+  finished its previous one. So threads, that run into cheap regions
+  ( f.e. masked by NaN values ), take over the work of the others
+  and all cores are busy until the image is completed.
+
+  The calling thread renders tiles too. Additional threads are only
+  taken from the thread pool, when they are available immediately.
+  So render() never waits for other jobs of the pool and can be
+  called from threads of the pool itself.
+
+  statistics() offers some information about the last rendered
+  image, that might be helpful for finding a good tile size.
+
+  \sa QwtPlotRasterItem::tileScheduler()
+*/
+class QWT_EXPORT QwtRasterTileScheduler
+{
+public:
+    /*!
+      \brief A job, that renders the tiles of an image
+
+      renderTile() is called from different threads in parallel.
+     */
+    class QWT_EXPORT Task
+    {
+    public:
+        virtual ~Task();
+
+        /*!
+          Render a tile
+          \param tile Geometry of the tile in image coordinates
+         */
+        virtual void renderTile( const QRect &tile ) = 0;
+    };
+
+    //! Information about the last image, that has been rendered
+    class QWT_EXPORT Statistics
+    {
+    public:
+        Statistics();
+
+        double imbalance() const;
+
+        //! Number of tiles
+        int numTiles;
+
+        //! Number of threads, including the calling thread
+        int numThreads;
+
+        //! Time between start and end of render() in ms
+        double wallTime;
+
+        //! Sum of the times, that the threads were busy in ms
+        double busyTime;
+
+        //! Time of the thread, that was busy for the longest time in ms
+        double maxBusyTime;
+    };
+
+    QwtRasterTileScheduler();
+    virtual ~QwtRasterTileScheduler();
+
+    void setThreadPool( QThreadPool * );
+    QThreadPool *threadPool() const;
+
+    void setMaxThreadCount( int );
+    int maxThreadCount() const;
+
+    void setTileSize( const QSize & );
+    QSize tileSize() const;
+
+    bool render( const QSize &imageSize, Task *, int numThreads = 0 );
+    void cancel();
+
+    Statistics statistics() const;
+
+private:
+    QwtRasterTileScheduler( const QwtRasterTileScheduler & );
+    QwtRasterTileScheduler &operator=( const QwtRasterTileScheduler & );
+
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
@@ -9,9 +9,91 @@
 
 #include "qwt_scale_map.h"
 #include "qwt_math.h"
+#include "qwt_simd_p.h"
 #include <qrect.h>
 #include <qdebug.h>
 
+/*
+  p = p1 + ( s - ts1 ) * cnv for an array of values. The
+  calculation is the same as in QwtScaleMap::transform(), so that 
+  the results are identical to mapping the values one by one.
+ */
+static void qwtLinearTransform( double p1, double ts1, double cnv,
+    const double *values, double *transformed, int numValues )
+{
+    int i = 0;
+
+#if QWT_USE_AVX
+    const __m256d vp1 = _mm256_set1_pd( p1 );
+    const __m256d vts1 = _mm256_set1_pd( ts1 );
+    const __m256d vcnv = _mm256_set1_pd( cnv );
+
+    for ( ; i + 4 <= numValues; i += 4 )
+    {
+        __m256d v = _mm256_loadu_pd( values + i );
+        v = _mm256_add_pd( vp1, _mm256_mul_pd( _mm256_sub_pd( v, vts1 ), vcnv ) );
+        _mm256_storeu_pd( transformed + i, v );
+    }
+#elif QWT_USE_SSE2
+    const __m128d vp1 = _mm_set1_pd( p1 );
+    const __m128d vts1 = _mm_set1_pd( ts1 );
+    const __m128d vcnv = _mm_set1_pd( cnv );
+
+    for ( ; i + 2 <= numValues; i += 2 )
+    {
+        __m128d v = _mm_loadu_pd( values + i );
+        v = _mm_add_pd( vp1, _mm_mul_pd( _mm_sub_pd( v, vts1 ), vcnv ) );
+        _mm_storeu_pd( transformed + i, v );
+    }
+#endif
+
+    for ( ; i < numValues; i++ )
+        transformed[i] = p1 + ( values[i] - ts1 ) * cnv;
+}
+
+/*
+  The same as qwtLinearTransform for an array of interleaved 
+  x/y coordinates. As the factors for x and y are different the
+  SIMD registers are loaded with pairs of them.
+ */
+static void qwtLinearTransform2( 
+    double p1X, double ts1X, double cnvX,
+    double p1Y, double ts1Y, double cnvY,
+    const double *values, double *transformed, int numPoints )
+{
+    int i = 0;
+
+#if QWT_USE_AVX
+    const __m256d vp1 = _mm256_setr_pd( p1X, p1Y, p1X, p1Y );
+    const __m256d vts1 = _mm256_setr_pd( ts1X, ts1Y, ts1X, ts1Y );
+    const __m256d vcnv = _mm256_setr_pd( cnvX, cnvY, cnvX, cnvY );
+
+    for ( ; i + 2 <= numPoints; i += 2 )
+    {
+        __m256d v = _mm256_loadu_pd( values + 2 * i );
+        v = _mm256_add_pd( vp1, _mm256_mul_pd( _mm256_sub_pd( v, vts1 ), vcnv ) );
+        _mm256_storeu_pd( transformed + 2 * i, v );
+    }
+#elif QWT_USE_SSE2
+    const __m128d vp1 = _mm_setr_pd( p1X, p1Y );
+    const __m128d vts1 = _mm_setr_pd( ts1X, ts1Y );
+    const __m128d vcnv = _mm_setr_pd( cnvX, cnvY );
+
+    for ( ; i < numPoints; i++ )
+    {
+        __m128d v = _mm_loadu_pd( values + 2 * i );
+        v = _mm_add_pd( vp1, _mm_mul_pd( _mm_sub_pd( v, vts1 ), vcnv ) );
+        _mm_storeu_pd( transformed + 2 * i, v );
+    }
+#endif
+
+    for ( ; i < numPoints; i++ )
+    {
+        transformed[2 * i] = p1X + ( values[2 * i] - ts1X ) * cnvX;
+        transformed[2 * i + 1] = p1Y + ( values[2 * i + 1] - ts1Y ) * cnvY;
+    }
+}
+
 /*!
   \brief Constructor
 
@@ -139,6 +221,99 @@ void QwtScaleMap::updateFactor()
         d_cnv = ( d_p2 - d_p1 ) / ( ts2 - d_ts1 );
 }
 
+/*!
+  \brief Transform an array of values from scale to paint coordinates
+
+  The result is the same as calling transform() for each value,
+  but the transformation is done with one virtual call of 
+  QwtTransform::transformValues() and a vectorized linear mapping. 
+
+  \param values Values relative to the coordinates of the scale
+  \param transformed Buffer for the transformed values,
+                     might be the same as values
+  \param numValues Number of values
+
+  \sa transform()
+*/
+void QwtScaleMap::transform( const double *values, 
+    double *transformed, int numValues ) const
+{
+    if ( numValues <= 0 )
+        return;
+
+    if ( d_transform )
+    {
+        d_transform->transformValues( values, transformed, numValues );
+        values = transformed;
+    }
+
+    qwtLinearTransform( d_p1, d_ts1, d_cnv, 
+        values, transformed, numValues );
+}
+
+/*!
+   \brief Transform an array of points from scale to paint coordinates
+
+   The result is the same as calling transform() for the 
+   coordinates of each point.
+
+   \param xMap X map
+   \param yMap Y map
+   \param points Points in scale coordinates
+   \param transformed Buffer for the points in paint coordinates,
+                      might be the same as points
+   \param numPoints Number of points
+*/
+void QwtScaleMap::transform( const QwtScaleMap &xMap,
+    const QwtScaleMap &yMap, const QPointF *points, 
+    QPointF *transformed, int numPoints )
+{
+    if ( numPoints <= 0 )
+        return;
+
+    if ( sizeof( QPointF ) == 2 * sizeof( double ) &&
+        xMap.d_transform == NULL && yMap.d_transform == NULL )
+    {
+        // QPointF is an array of 2 doubles, what allows
+        // to map x and y coordinates in one pass
+
+        qwtLinearTransform2( 
+            xMap.d_p1, xMap.d_ts1, xMap.d_cnv,
+            yMap.d_p1, yMap.d_ts1, yMap.d_cnv,
+            reinterpret_cast<const double *>( points ),
+            reinterpret_cast<double *>( transformed ), numPoints );
+
+        return;
+    }
+
+    const int chunkSize = 256;
+
+    double x[chunkSize];
+    double y[chunkSize];
+
+    for ( int i = 0; i < numPoints; i += chunkSize )
+    {
+        const int n = qMin( chunkSize, numPoints - i );
+
+        const QPointF *p = points + i;
+        for ( int j = 0; j < n; j++ )
+        {
+            x[j] = p[j].x();
+            y[j] = p[j].y();
+        }
+
+        xMap.transform( x, x, n );
+        yMap.transform( y, y, n );
+
+        QPointF *t = transformed + i;
+        for ( int j = 0; j < n; j++ )
+        {
+            t[j].rx() = x[j];
+            t[j].ry() = y[j];
+        }
+    }
+}
+
 /*!
    Transform a rectangle from scale to paint coordinates
 
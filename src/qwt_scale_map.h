@@ -46,6 +46,9 @@ public:
     double transform( double s ) const;
     double invTransform( double p ) const;
 
+    void transform( const double *values, 
+        double *transformed, int numValues ) const;
+
     double p1() const;
     double p2() const;
 
@@ -65,6 +68,9 @@ public:
     static QPointF invTransform( const QwtScaleMap &,
         const QwtScaleMap &, const QPointF & );
 
+    static void transform( const QwtScaleMap &, const QwtScaleMap &,
+        const QPointF *points, QPointF *transformed, int numPoints );
+
     bool isInverting() const;
 
 private:
@@ -83,10 +83,12 @@ QRectF qwtBoundingRectT(
     if ( to < from )
         return boundingRect;
 
+    QwtSeriesReader<T> reader( &series, from, to );
+
     int i;
     for ( i = from; i <= to; i++ )
     {
-        const QRectF rect = qwtBoundingRect( series.sample( i ) );
+        const QRectF rect = qwtBoundingRect( reader.sample( i ) );
         if ( rect.width() >= 0.0 && rect.height() >= 0.0 )
         {
             boundingRect = rect;
@@ -97,7 +99,7 @@ QRectF qwtBoundingRectT(
 
     for ( ; i <= to; i++ )
     {
-        const QRectF rect = qwtBoundingRect( series.sample( i ) );
+        const QRectF rect = qwtBoundingRect( reader.sample( i ) );
         if ( rect.width() >= 0.0 && rect.height() >= 0.0 )
         {
             boundingRect.setLeft( qMin( boundingRect.left(), rect.left() ) );
@@ -41,6 +41,18 @@
      but often it is possible to implement a more efficient algorithm 
      depending on the characteristics of the series.
      The member d_boundingRect is intended for caching the calculated rectangle.
+
+   Algorithms iterating over many samples retrieve them in chunks 
+   using copySamples(). Implementations, that have the samples in memory,
+   should reimplement it to avoid a virtual call of sample() per sample.
+
+   Information about the samples, that is expensive to calculate
+   ( f.e. QwtPointIndex or the order of the samples in QwtPlotCurve ),
+   is cached together with revision(). Whenever the samples are modified
+   without replacing the series, incrementRevision() has to be called.
+   The implementations of Qwt do this in their methods modifying the
+   samples, but samples modified in place ( f.e. the memory blocks of
+   QwtCPointerData ) need to be announced by the application.
     
 */
 template <typename T>
@@ -90,17 +102,54 @@ public:
     */
     virtual void setRectOfInterest( const QRectF &rect );
 
+    /*!
+       \brief Copy a range of samples into a buffer
+
+       The default implementation calls sample() for each sample.
+       Implementations, that have the samples in memory, should
+       reimplement it with a tight loop to avoid the virtual call
+       per sample.
+
+       \param from Index of the first sample
+       \param numSamples Number of samples to copy
+       \param samples Buffer for at least numSamples samples
+
+       \sa QwtSeriesReader
+    */
+    virtual void copySamples( size_t from, 
+        size_t numSamples, T *samples ) const;
+
+    /*!
+       \return Revision of the samples, that is incremented,
+               whenever the samples have been modified
+       \sa incrementRevision()
+     */
+    uint revision() const;
+
+    /*!
+       \brief Announce a modification of the samples
+
+       Invalidates all information, that has been cached for the
+       current samples by the items displaying the series.
+
+       \sa revision()
+     */
+    void incrementRevision();
+
 protected:
     //! Can be used to cache a calculated bounding rectangle
     mutable QRectF d_boundingRect;
 
 private:
     QwtSeriesData<T> &operator=( const QwtSeriesData<T> & );
+
+    uint d_revision;
 };
 
 template <typename T>
 QwtSeriesData<T>::QwtSeriesData():
-    d_boundingRect( 0.0, 0.0, -1.0, -1.0 )
+    d_boundingRect( 0.0, 0.0, -1.0, -1.0 ),
+    d_revision( 0 )
 {
 }
 
@@ -114,6 +163,113 @@ void QwtSeriesData<T>::setRectOfInterest( const QRectF & )
 {
 }
 
+template <typename T>
+uint QwtSeriesData<T>::revision() const
+{
+    return d_revision;
+}
+
+template <typename T>
+void QwtSeriesData<T>::incrementRevision()
+{
+    d_revision++;
+}
+
+template <typename T>
+void QwtSeriesData<T>::copySamples( 
+    size_t from, size_t numSamples, T *samples ) const
+{
+    for ( size_t i = 0; i < numSamples; i++ )
+        samples[i] = sample( from + i );
+}
+
+/*!
+  \brief Sequential access to the samples of a series
+
+  QwtSeriesReader retrieves the samples in chunks using 
+  QwtSeriesData<T>::copySamples(), so that loops iterating 
+  over a series have one virtual call per chunk instead of 
+  one per sample.
+
+  The samples are expected to be requested in increasing order,
+  but any other order is supported at the cost of reloading a chunk.
+
+  \code
+QwtSeriesReader<QPointF> reader( series, from, to );
+for ( int i = from; i <= to; i++ )
+{
+    const QPointF &sample = reader.sample( i );
+    ...
+}
+  \endcode
+*/
+template <typename T>
+class QwtSeriesReader
+{
+public:
+    /*!
+      Constructor
+
+      \param series Series
+      \param from Index of the first sample to be read
+      \param to Index of the last sample to be read
+    */
+    QwtSeriesReader( const QwtSeriesData<T> *series, int from, int to );
+
+    /*!
+      \param index Index between from and to
+      \return Sample at position index
+     */
+    const T &sample( int index );
+
+private:
+    void load( int index );
+
+    enum { ChunkSize = 256 };
+
+    const QwtSeriesData<T> *d_series;
+    const int d_to;
+
+    int d_first;
+    int d_count;
+
+    T d_buffer[ChunkSize];
+};
+
+template <typename T>
+QwtSeriesReader<T>::QwtSeriesReader( 
+        const QwtSeriesData<T> *series, int from, int to ):
+    d_series( series ),
+    d_to( to ),
+    d_first( from ),
+    d_count( 0 )
+{
+}
+
+template <typename T>
+inline const T &QwtSeriesReader<T>::sample( int index )
+{
+    if ( index < d_first || index >= d_first + d_count )
+        load( index );
+
+    return d_buffer[ index - d_first ];
+}
+
+template <typename T>
+void QwtSeriesReader<T>::load( int index )
+{
+    d_first = index;
+    d_count = qMin( int( ChunkSize ), d_to - index + 1 );
+
+    if ( d_count < 1 )
+    {
+        // out of the range, that has been announced
+        d_count = 1;
+    }
+
+    d_series->copySamples( d_first, d_count, d_buffer );
+}
+
 /*!
   \brief Template class for data, that is organized as QVector
 
@@ -153,6 +309,9 @@ public:
     */
     virtual T sample( size_t index ) const;
 
+    virtual void copySamples( size_t from, 
+        size_t numSamples, T *samples ) const;
+
 protected:
     //! Vector of samples
     QVector<T> d_samples;
@@ -174,6 +333,8 @@ void QwtArraySeriesData<T>::setSamples( const QVector<T> &samples )
 {
     QwtSeriesData<T>::d_boundingRect = QRectF( 0.0, 0.0, -1.0, -1.0 );
     d_samples = samples;
+
+    QwtSeriesData<T>::incrementRevision();
 }
 
 template <typename T>
@@ -194,6 +355,23 @@ T QwtArraySeriesData<T>::sample( size_t i ) const
     return d_samples[ static_cast<int>( i ) ];
 }
 
+/*!
+  Copy a range of samples into a buffer
+
+  \param from Index of the first sample
+  \param numSamples Number of samples to copy
+  \param samples Buffer for at least numSamples samples
+*/
+template <typename T>
+void QwtArraySeriesData<T>::copySamples( 
+    size_t from, size_t numSamples, T *samples ) const
+{
+    const T *values = d_samples.constData() + from;
+
+    for ( size_t i = 0; i < numSamples; i++ )
+        samples[i] = values[i];
+}
+
 //! Interface for iterating over an array of points
 class QWT_EXPORT QwtPointSeriesData: public QwtArraySeriesData<QPointF>
 {
@@ -0,0 +1,33 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_SIMD_P_H
+#define QWT_SIMD_P_H 1
+
+/*
+  Private header, that is not installed: selects the instruction sets
+  for the vectorized loops from the flags of the compiler.
+
+  QWT_USE_AVX is set, when the code is compiled for AVX,
+  QWT_USE_SSE2 for SSE2, what is always available on x86_64.
+  As AVX implies SSE2 both are set for AVX builds.
+ */
+
+#if defined( __AVX__ )
+#define QWT_USE_AVX 1
+#include <immintrin.h>
+#endif
+
+#if defined( QWT_USE_AVX ) || defined( __SSE2__ ) || defined( _M_X64 ) \
+    || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define QWT_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#endif
@@ -16,9 +16,12 @@
 #include <qpixmap.h>
 #include <qpaintengine.h>
 #include <qmath.h>
+#include <qimage.h>
+#include <qvector.h>
 #ifndef QWT_NO_SVG
 #include <qsvgrenderer.h>
 #endif
+#include <algorithm>
 
 namespace QwtTriangle
 {
@@ -767,6 +770,170 @@ static inline void qwtDrawHexagonSymbols( QPainter *painter,
     }
 }
 
+// multiply all channels of a premultiplied pixel with alpha / 255
+static inline uint qwtByteMul( uint x, uint alpha )
+{
+    uint t = ( x & 0xff00ff ) * alpha;
+    t = ( t + ( ( t >> 8 ) & 0xff00ff ) + 0x800080 ) >> 8;
+    t &= 0xff00ff;
+
+    x = ( ( x >> 8 ) & 0xff00ff ) * alpha;
+    x = ( x + ( ( x >> 8 ) & 0xff00ff ) + 0x800080 );
+    x &= 0xff00ff00;
+
+    return x | t;
+}
+
+static inline void qwtBlendSprite( const QImage &sprite,
+    const QPoint &pos, const QRect &rect, uchar *bits, int bytesPerLine )
+{
+    const int sx = rect.left() - pos.x();
+    const int sy = rect.top() - pos.y();
+    const int width = rect.width();
+
+    for ( int y = 0; y < rect.height(); y++ )
+    {
+        const QRgb *src = reinterpret_cast<const QRgb *>(
+            sprite.scanLine( sy + y ) ) + sx;
+
+        QRgb *dst = reinterpret_cast<QRgb *>(
+            bits + ( rect.top() + y ) * bytesPerLine ) + rect.left();
+
+        for ( int x = 0; x < width; x++ )
+        {
+            const QRgb s = src[x];
+
+            const uint alpha = qAlpha( s );
+            if ( alpha == 255 )
+                dst[x] = s;
+            else if ( alpha != 0 )
+                dst[x] = s + qwtByteMul( dst[x], 255 - alpha );
+        }
+    }
+}
+
+/*
+  Blend a premultiplied sprite into the scanlines of the image
+  the painter is operating on, bypassing the paint engine.
+  Returns false, when the painter state can't be handled.
+ */
+static bool qwtBlitSymbols( QPainter *painter, const QImage &sprite,
+    const QPoint &offset, const QPointF *points, int numPoints )
+{
+    if ( painter->opacity() < 1.0 || painter->compositionMode()
+        != QPainter::CompositionMode_SourceOver )
+    {
+        return false;
+    }
+
+    const QTransform transform = painter->deviceTransform();
+    if ( transform.type() > QTransform::TxTranslate )
+        return false;
+
+    QPaintEngine *engine = painter->paintEngine();
+    if ( engine == NULL || engine->type() != QPaintEngine::Raster )
+        return false;
+
+    // when painting on widgets or pixmaps, the raster
+    // engine operates on an image too
+    QPaintDevice *device = engine->paintDevice();
+    if ( device == NULL || device->devType() != QInternal::Image )
+        return false;
+
+    QImage *image = static_cast<QImage *>( device );
+    if ( image->format() != QImage::Format_RGB32 &&
+        image->format() != QImage::Format_ARGB32_Premultiplied )
+    {
+        return false;
+    }
+
+    const int tx = qRound( transform.dx() );
+    const int ty = qRound( transform.dy() );
+
+    QRegion clipRegion( image->rect() );
+
+    const QRegion systemClip = engine->systemClip();
+    if ( !systemClip.isEmpty() )
+        clipRegion &= systemClip;
+
+    if ( painter->hasClipping() )
+        clipRegion &= painter->clipRegion().translated( tx, ty );
+
+    if ( clipRegion.isEmpty() )
+        return true;
+
+    const QVector<QRect> clipRects = clipRegion.rects();
+
+    // sprites inside of the largest rectangle need no further clipping
+    QRect innerRect;
+    for ( int i = 0; i < clipRects.size(); i++ )
+    {
+        const QRect &r = clipRects[i];
+        if ( r.width() * r.height() > innerRect.width() * innerRect.height() )
+            innerRect = r;
+    }
+
+    const QRect clipRect = clipRegion.boundingRect();
+    const QSize size = sprite.size();
+
+    // positions of the sprites, that are ( partly ) visible,
+    // relative to x0/y0 with y in the upper 32 bits
+
+    const int x0 = clipRect.left() - size.width();
+    const int y0 = clipRect.top() - size.height();
+
+    QVector<quint64> positions;
+    positions.reserve( numPoints );
+
+    for ( int i = 0; i < numPoints; i++ )
+    {
+        const int x = qRound( points[i].x() ) + offset.x() + tx;
+        const int y = qRound( points[i].y() ) + offset.y() + ty;
+
+        if ( x > clipRect.right() || y > clipRect.bottom()
+            || x + size.width() <= clipRect.left()
+            || y + size.height() <= clipRect.top() )
+        {
+            continue;
+        }
+
+        positions += ( quint64( y - y0 ) << 32 ) | quint64( x - x0 );
+    }
+
+    // blending a sprite twice to the same position is a waste of time,
+    // and sorting increases the locality of the memory accesses
+    std::sort( positions.begin(), positions.end() );
+    positions.erase( std::unique( positions.begin(), positions.end() ),
+        positions.end() );
+
+    uchar *bits = image->bits();
+    const int bytesPerLine = image->bytesPerLine();
+
+    for ( int i = 0; i < positions.size(); i++ )
+    {
+        const QPoint pos( int( positions[i] & 0xffffffff ) + x0,
+            int( positions[i] >> 32 ) + y0 );
+
+        const QRect spriteRect( pos, size );
+
+        if ( innerRect.contains( spriteRect ) )
+        {
+            qwtBlendSprite( sprite, pos, spriteRect, bits, bytesPerLine );
+        }
+        else
+        {
+            for ( int j = 0; j < clipRects.size(); j++ )
+            {
+                const QRect rect = spriteRect & clipRects[j];
+                if ( !rect.isEmpty() )
+                    qwtBlendSprite( sprite, pos, rect, bits, bytesPerLine );
+            }
+        }
+    }
+
+    return true;
+}
+
 class QwtSymbol::PrivateData
 {
 public:
@@ -830,6 +997,9 @@ public:
         QwtSymbol::CachePolicy policy;
         QPixmap pixmap;
 
+        // premultiplied copy of the pixmap for qwtBlitSymbols()
+        QImage image;
+
     } cache;
 };
 
@@ -1299,6 +1469,11 @@ bool QwtSymbol::isPinPointEnabled() const
   one by one, as a couple of layout calculations and setting of pen/brush
   can be done once for the complete array.
 
+  When the cached pixmap is used and the raster paint engine operates
+  on a 32 bit image without scaling, the symbols are blended into
+  the scanlines of the image directly. Symbols at identical pixel
+  positions are painted only once.
+
   \param painter Painter
   \param points Array of points
   \param numPoints Number of points
@@ -1372,6 +1547,23 @@ void QwtSymbol::drawSymbols( QPainter *painter,
             renderSymbols( &p, &pos, 1 );
         }
 
+        if ( painter->paintEngine()->type() == QPaintEngine::Raster )
+        {
+            QImage &image = d_data->cache.image;
+            if ( image.isNull() )
+            {
+                image = d_data->cache.pixmap.toImage().convertToFormat(
+                    QImage::Format_ARGB32_Premultiplied );
+            }
+
+            // the pixels of a high DPI pixmap don't match the device
+            if ( image.size() == br.size() && qwtBlitSymbols(
+                painter, image, br.topLeft(), points, numPoints ) )
+            {
+                return;
+            }
+        }
+
         const int dx = br.left();
         const int dy = br.top();
 
@@ -1743,6 +1935,9 @@ void QwtSymbol::invalidateCache()
 {
     if ( !d_data->cache.pixmap.isNull() )
         d_data->cache.pixmap = QPixmap();
+
+    if ( !d_data->cache.image.isNull() )
+        d_data->cache.image = QImage();
 }
 
 /*!
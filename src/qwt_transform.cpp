@@ -9,6 +9,8 @@
 
 #include "qwt_transform.h"
 #include "qwt_math.h"
+#include <string.h>
+#include <typeinfo>
 
 #if QT_VERSION < 0x040601
 #define qExp(x) ::exp(x)
@@ -39,6 +41,33 @@ double QwtTransform::bounded( double value ) const
     return value;
 }
 
+/*!
+  \brief Transform an array of values
+
+  The default implementation calls transform() for each value.
+  Transformations, that are used for huge series of values, should
+  reimplement it with a loop, that does not need a virtual call per value.
+
+  QwtNullTransform, QwtLogTransform and QwtPowerTransform reimplement
+  transformValues() with the formula of their transform(). As a
+  derived class might have reimplemented transform() these loops
+  are used for objects of exactly these classes only - otherwise
+  transform() is called for each value.
+
+  \param values Values to be transformed
+  \param transformed Buffer for the transformed values, 
+                     might be the same as values
+  \param numValues Number of values
+
+  \sa QwtScaleMap::transform()
+ */
+void QwtTransform::transformValues( const double *values, 
+    double *transformed, int numValues ) const
+{
+    for ( int i = 0; i < numValues; i++ )
+        transformed[i] = transform( values[i] );
+}
+
 //! Constructor
 QwtNullTransform::QwtNullTransform():
     QwtTransform()
@@ -68,6 +97,24 @@ double QwtNullTransform::invTransform( double value ) const
     return value;
 }
 
+/*! 
+  \param values Values to be transformed
+  \param transformed Buffer for the unmodified values
+  \param numValues Number of values
+ */
+void QwtNullTransform::transformValues( const double *values, 
+    double *transformed, int numValues ) const
+{
+    if ( typeid( *this ) != typeid( QwtNullTransform ) )
+    {
+        QwtTransform::transformValues( values, transformed, numValues );
+        return;
+    }
+
+    if ( transformed != values )
+        ::memcpy( transformed, values, numValues * sizeof( double ) );
+}
+
 //! \return Clone of the transformation
 QwtTransform *QwtNullTransform::copy() const
 {
@@ -103,6 +150,24 @@ double QwtLogTransform::invTransform( double value ) const
     return qExp( value );
 }
 
+/*! 
+  \param values Values to be transformed
+  \param transformed Buffer for log( value )
+  \param numValues Number of values
+ */
+void QwtLogTransform::transformValues( const double *values, 
+    double *transformed, int numValues ) const
+{
+    if ( typeid( *this ) != typeid( QwtLogTransform ) )
+    {
+        QwtTransform::transformValues( values, transformed, numValues );
+        return;
+    }
+
+    for ( int i = 0; i < numValues; i++ )
+        transformed[i] = ::log( values[i] );
+}
+
 /*! 
   \param value Value to be bounded
   \return qBound( LogMin, value, LogMax )
@@ -158,6 +223,33 @@ double QwtPowerTransform::invTransform( double value ) const
         return qPow( value, d_exponent );
 }
 
+/*! 
+  \param values Values to be transformed
+  \param transformed Buffer for the exponentiations preserving the sign
+  \param numValues Number of values
+ */
+void QwtPowerTransform::transformValues( const double *values, 
+    double *transformed, int numValues ) const
+{
+    if ( typeid( *this ) != typeid( QwtPowerTransform ) )
+    {
+        QwtTransform::transformValues( values, transformed, numValues );
+        return;
+    }
+
+    const double exponent = 1.0 / d_exponent;
+
+    for ( int i = 0; i < numValues; i++ )
+    {
+        const double value = values[i];
+
+        if ( value < 0.0 )
+            transformed[i] = -qPow( -value, exponent );
+        else
+            transformed[i] = qPow( value, exponent );
+    }
+}
+
 //! \return Clone of the transformation
 QwtTransform *QwtPowerTransform::copy() const
 {
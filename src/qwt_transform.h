@@ -64,6 +64,9 @@ public:
      */
     virtual double invTransform( double value ) const = 0;
 
+    virtual void transformValues( const double *values, 
+        double *transformed, int numValues ) const;
+
     //! Virtualized copy operation
     virtual QwtTransform *copy() const = 0;
 };
@@ -83,6 +86,9 @@ public:
     virtual double transform( double value ) const;
     virtual double invTransform( double value ) const;
 
+    virtual void transformValues( const double *values, 
+        double *transformed, int numValues ) const;
+
     virtual QwtTransform *copy() const;
 };
 /*!
@@ -103,6 +109,9 @@ public:
     virtual double transform( double value ) const;
     virtual double invTransform( double value ) const;
 
+    virtual void transformValues( const double *values, 
+        double *transformed, int numValues ) const;
+
     virtual double bounded( double value ) const;
 
     virtual QwtTransform *copy() const;
@@ -128,6 +137,9 @@ public:
     virtual double transform( double value ) const;
     virtual double invTransform( double value ) const;
 
+    virtual void transformValues( const double *values, 
+        double *transformed, int numValues ) const;
+
     virtual QwtTransform *copy() const;
 
 private:
@@ -0,0 +1,393 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_waterfall_raster_data.h"
+#include <qnumeric.h>
+#include <qmath.h>
+#include <qalgorithms.h>
+#include <float.h>
+#include <string.h>
+
+class QwtWaterfallRasterData::PrivateData
+{
+public:
+    PrivateData():
+        numColumns( 0 ),
+        capacity( 0 ),
+        numAppended( 0 ),
+        size( 0 ),
+        origin( 0.0 ),
+        rowHeight( 1.0 ),
+        dx( 0.0 )
+    {
+    }
+
+    // absolute number of the oldest row
+    inline qint64 firstRow() const
+    {
+        return numAppended - size;
+    }
+
+    inline const double *rowData( qint64 row ) const
+    {
+        return buffer.constData() + ( row % capacity ) * numColumns;
+    }
+
+    inline int columnIndex( const QwtInterval &interval, double x ) const
+    {
+        if ( !interval.contains( x ) )
+            return -1;
+
+        // see QwtMatrixRasterData::value()
+        return qMin( int( ( x - interval.minValue() ) / dx ), numColumns - 1 );
+    }
+
+    int numColumns;
+    int capacity;
+
+    QVector<double> buffer;
+
+    qint64 numAppended;
+    int size;
+
+    double origin;
+    double rowHeight;
+
+    double dx;
+};
+
+/*!
+  \brief Constructor
+
+  \param numColumns Number of values of a row
+  \param capacity Maximum number of rows. When more rows are appended
+                  the oldest rows are dropped.
+ */
+QwtWaterfallRasterData::QwtWaterfallRasterData(
+    int numColumns, int capacity )
+{
+    d_data = new PrivateData();
+
+    d_data->numColumns = qMax( numColumns, 1 );
+    d_data->capacity = qMax( capacity, 1 );
+
+    d_data->buffer.resize( d_data->numColumns * d_data->capacity );
+}
+
+//! Destructor
+QwtWaterfallRasterData::~QwtWaterfallRasterData()
+{
+    delete d_data;
+}
+
+//! \return Number of values of a row
+int QwtWaterfallRasterData::numColumns() const
+{
+    return d_data->numColumns;
+}
+
+//! \return Maximum number of rows
+int QwtWaterfallRasterData::capacity() const
+{
+    return d_data->capacity;
+}
+
+//! \return Number of rows, that are available
+int QwtWaterfallRasterData::numRows() const
+{
+    return d_data->size;
+}
+
+/*!
+  \brief Set the y position of the first row
+
+  The position of the first row ever appended, f.e. the time, when
+  the acquisition has been started. The default origin is 0.0.
+
+  \param origin Y position of the first row
+  \sa origin(), setRowHeight()
+ */
+void QwtWaterfallRasterData::setOrigin( double origin )
+{
+    d_data->origin = origin;
+    updateInterval();
+}
+
+/*!
+  \return Y position of the first row
+  \sa setOrigin()
+ */
+double QwtWaterfallRasterData::origin() const
+{
+    return d_data->origin;
+}
+
+/*!
+  \brief Set the height of a row
+
+  The height is the distance between 2 rows in y direction, f.e. the
+  time between 2 spectra. The default height is 1.0.
+
+  \param height Height of a row
+  \sa rowHeight(), setOrigin()
+ */
+void QwtWaterfallRasterData::setRowHeight( double height )
+{
+    if ( height > 0.0 )
+    {
+        d_data->rowHeight = height;
+        updateInterval();
+    }
+}
+
+/*!
+  \return Height of a row
+  \sa setRowHeight()
+ */
+double QwtWaterfallRasterData::rowHeight() const
+{
+    return d_data->rowHeight;
+}
+
+/*!
+  \brief Append a row
+
+  The values are copied into the ring buffer. When the buffer
+  is full, the oldest row is dropped.
+
+  \param values Array of numColumns() values
+  \return Area of the new row
+
+  \sa QwtPlotRasterItem::invalidateCacheArea()
+ */
+QRectF QwtWaterfallRasterData::appendRow( const double *values )
+{
+    PrivateData *d = d_data;
+
+    const int slot = int( d->numAppended % d->capacity );
+    ::memcpy( d->buffer.data() + slot * d->numColumns,
+        values, d->numColumns * sizeof( double ) );
+
+    d->numAppended++;
+    if ( d->size < d->capacity )
+        d->size++;
+
+    updateInterval();
+
+    QRectF rect;
+    rect.setTop( d->origin + ( d->numAppended - 1 ) * d->rowHeight );
+    rect.setHeight( d->rowHeight );
+
+    const QwtInterval xInterval = interval( Qt::XAxis );
+    if ( xInterval.isValid() )
+    {
+        rect.setLeft( xInterval.minValue() );
+        rect.setRight( xInterval.maxValue() );
+    }
+    else
+    {
+        rect.setLeft( -0.5 * FLT_MAX );
+        rect.setWidth( FLT_MAX );
+    }
+
+    return rect;
+}
+
+/*!
+  \brief Append a row
+
+  \param values Vector of values. Missing values are filled with NaN,
+                additional values are ignored.
+  \return Area of the new row
+
+  \sa QwtPlotRasterItem::invalidateCacheArea()
+ */
+QRectF QwtWaterfallRasterData::appendRow( const QVector<double> &values )
+{
+    if ( values.size() >= d_data->numColumns )
+        return appendRow( values.constData() );
+
+    QVector<double> row( d_data->numColumns, qQNaN() );
+    ::memcpy( row.data(), values.constData(),
+        values.size() * sizeof( double ) );
+
+    return appendRow( row.constData() );
+}
+
+/*!
+  \brief Remove all rows
+
+  Rows, that are appended later, continue at the y position,
+  where the last row would have been appended.
+ */
+void QwtWaterfallRasterData::clear()
+{
+    d_data->size = 0;
+    updateInterval();
+}
+
+/*!
+  \param index Index of the row, where 0 is the oldest row
+  \return Values of the row, or NULL for an invalid index
+ */
+const double *QwtWaterfallRasterData::row( int index ) const
+{
+    if ( index < 0 || index >= d_data->size )
+        return NULL;
+
+    return d_data->rowData( d_data->firstRow() + index );
+}
+
+/*!
+   \brief Assign the bounding interval for an axis
+
+   The intervals for the x and z axis have the same meaning as for
+   QwtMatrixRasterData. The interval of the y axis is calculated
+   from the rows and can't be changed.
+
+   \param axis X, Y or Z axis
+   \param interval Interval
+
+   \sa setOrigin(), setRowHeight()
+*/
+void QwtWaterfallRasterData::setInterval(
+    Qt::Axis axis, const QwtInterval &interval )
+{
+    if ( axis == Qt::YAxis )
+        return;
+
+    QwtRasterData::setInterval( axis, interval );
+
+    if ( axis == Qt::XAxis )
+    {
+        d_data->dx = 0.0;
+        if ( interval.isValid() )
+            d_data->dx = interval.width() / d_data->numColumns;
+    }
+}
+
+/*!
+   \brief Calculate the pixel hint
+
+   \param area Requested area, ignored
+   \return The surrounding pixel of the first value of the oldest row
+*/
+QRectF QwtWaterfallRasterData::pixelHint( const QRectF &area ) const
+{
+    Q_UNUSED( area )
+
+    const QwtInterval xInterval = interval( Qt::XAxis );
+    if ( !xInterval.isValid() || d_data->size == 0 )
+        return QRectF();
+
+    return QRectF( xInterval.minValue(),
+        d_data->origin + d_data->firstRow() * d_data->rowHeight,
+        d_data->dx, d_data->rowHeight );
+}
+
+/*!
+   \return the value at a raster position
+
+   The value of the nearest neighbour is returned.
+
+   \param x X value in plot coordinates
+   \param y Y value in plot coordinates
+*/
+double QwtWaterfallRasterData::value( double x, double y ) const
+{
+    const int row = rowIndex( y );
+    const int col = d_data->columnIndex( interval( Qt::XAxis ), x );
+
+    if ( row < 0 || col < 0 )
+        return qQNaN();
+
+    return d_data->rowData( d_data->firstRow() + row )[ col ];
+}
+
+/*!
+   \brief Values of a raster
+
+   Resamples the rows like value(), but the indices of the columns
+   are calculated once for the raster.
+
+   \param x Array of x values in plot coordinates
+   \param numX Number of x values
+   \param y Array of y values in plot coordinates
+   \param numY Number of y values
+   \param values Buffer for at least numX * numY values
+
+   \sa value()
+*/
+void QwtWaterfallRasterData::values( const double *x, int numX,
+    const double *y, int numY, double *values ) const
+{
+    if ( numX <= 0 || numY <= 0 )
+        return;
+
+    const QwtInterval xInterval = interval( Qt::XAxis );
+
+    QVector<int> cols( numX );
+    for ( int c = 0; c < numX; c++ )
+        cols[c] = d_data->columnIndex( xInterval, x[c] );
+
+    const qint64 firstRow = d_data->firstRow();
+
+    for ( int r = 0; r < numY; r++ )
+    {
+        double *line = values + r * numX;
+
+        const int row = rowIndex( y[r] );
+        if ( row < 0 )
+        {
+            qFill( line, line + numX, qQNaN() );
+            continue;
+        }
+
+        const double *rowValues = d_data->rowData( firstRow + row );
+
+        for ( int c = 0; c < numX; c++ )
+        {
+            const int col = cols[c];
+            line[c] = ( col >= 0 ) ? rowValues[col] : qQNaN();
+        }
+    }
+}
+
+void QwtWaterfallRasterData::updateInterval()
+{
+    QwtInterval yInterval;
+
+    if ( d_data->size > 0 )
+    {
+        const double y1 = d_data->origin
+            + d_data->firstRow() * d_data->rowHeight;
+        const double y2 = d_data->origin
+            + d_data->numAppended * d_data->rowHeight;
+
+        yInterval.setInterval( y1, y2 );
+    }
+
+    QwtRasterData::setInterval( Qt::YAxis, yInterval );
+}
+
+// index of the row for y, where 0 is the oldest row, or -1
+int QwtWaterfallRasterData::rowIndex( double y ) const
+{
+    const QwtInterval yInterval = interval( Qt::YAxis );
+    if ( !yInterval.contains( y ) )
+        return -1;
+
+    const double pos = ( y - d_data->origin ) / d_data->rowHeight;
+    qint64 row = qint64( ::floor( pos ) ) - d_data->firstRow();
+
+    // the maximum of the interval belongs to the last row
+    row = qBound( qint64( 0 ), row, qint64( d_data->size - 1 ) );
+
+    return int( row );
+}
@@ -0,0 +1,102 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_WATERFALL_RASTER_DATA_H
+#define QWT_WATERFALL_RASTER_DATA_H 1
+
+#include "qwt_global.h"
+#include "qwt_raster_data.h"
+#include <qvector.h>
+
+/*!
+  \brief Raster data for a waterfall display
+
+  QwtWaterfallRasterData stores the most recent capacity() rows
+  of equidistant values ( f.e. the spectra of a signal ) in a ring buffer.
+  Appending a row costs O( numColumns() ), no matter how many rows
+  are displayed.
+
+  The x positions of the values are defined by the interval
+  of the x axis like for QwtMatrixRasterData. The rows are stacked
+  in y direction: row n, counted from the first row ever appended,
+  covers [ origin() + n * rowHeight(), origin() + ( n + 1 ) * rowHeight() [.
+  The interval of the y axis is updated, whenever a row is appended.
+
+  appendRow() returns the area of the new row, that can be passed
+  to QwtPlotRasterItem::invalidateCacheArea(). In combination with the
+  QwtPlotRasterItem::PaintCache policy, a spectrogram shifts its cached
+  image, when the y axis follows the data, and renders only the new row.
+
+  \par Example
+  \code
+#include <qwt_waterfall_raster_data.h>
+#include <qwt_plot_spectrogram.h>
+
+QwtWaterfallRasterData *data = new QwtWaterfallRasterData( 1024, 500 );
+data->setInterval( Qt::XAxis, QwtInterval( 0.0, 22050.0 ) );
+data->setInterval( Qt::ZAxis, QwtInterval( -90.0, 0.0 ) );
+
+spectrogram->setData( data );
+spectrogram->setCachePolicy( QwtPlotRasterItem::PaintCache );
+
+// for each spectrum
+const QRectF area = data->appendRow( spectrum );
+spectrogram->invalidateCacheArea( area );
+
+const QwtInterval yInterval = data->interval( Qt::YAxis );
+plot->setAxisScale( QwtPlot::yLeft, yInterval.minValue(), yInterval.maxValue() );
+plot->replot();
+  \endcode
+
+  \note The data is not protected against concurrent access. When the
+        spectrogram renders in background threads
+        ( QwtPlotRasterItem::AsynchronousRendering ) rows need to be
+        appended from the GUI thread.
+*/
+class QWT_EXPORT QwtWaterfallRasterData: public QwtRasterData
+{
+public:
+    explicit QwtWaterfallRasterData( int numColumns, int capacity );
+    virtual ~QwtWaterfallRasterData();
+
+    int numColumns() const;
+    int capacity() const;
+    int numRows() const;
+
+    void setOrigin( double );
+    double origin() const;
+
+    void setRowHeight( double );
+    double rowHeight() const;
+
+    QRectF appendRow( const double *values );
+    QRectF appendRow( const QVector<double> &values );
+
+    void clear();
+
+    const double *row( int index ) const;
+
+    virtual void setInterval( Qt::Axis, const QwtInterval & );
+
+    virtual QRectF pixelHint( const QRectF & ) const;
+
+    virtual double value( double x, double y ) const;
+
+    virtual void values( const double *x, int numX,
+        const double *y, int numY, double *values ) const;
+
+private:
+    void updateInterval();
+    int rowIndex( double y ) const;
+
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
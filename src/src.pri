@@ -48,6 +48,10 @@ HEADERS += \
     qwt_transform.h \
     qwt_widget_overlay.h
 
+# private headers, that are not installed
+PRIVATE_HEADERS += \
+    qwt_simd_p.h
+
 SOURCES += \
     qwt_abstract_scale_draw.cpp \
     qwt_clipper.cpp \
@@ -127,13 +131,18 @@ contains(QWT_CONFIG, QwtPlot) {
         qwt_plot_magnifier.h \
         qwt_plot_rescaler.h \
         qwt_point_mapper.h \
+        qwt_point_index.h \
         qwt_raster_data.h \
+        qwt_raster_tile_scheduler.h \
         qwt_matrix_raster_data.h \
+        qwt_waterfall_raster_data.h \
         qwt_sampling_thread.h \
         qwt_samples.h \
         qwt_series_data.h \
         qwt_series_store.h \
         qwt_point_data.h \
+        qwt_mapped_point_data.h \
+        qwt_circular_point_data.h \
         qwt_scale_widget.h 
 
     SOURCES += \
@@ -175,11 +184,16 @@ contains(QWT_CONFIG, QwtPlot) {
         qwt_plot_magnifier.cpp \
         qwt_plot_rescaler.cpp \
         qwt_point_mapper.cpp \
+        qwt_point_index.cpp \
         qwt_raster_data.cpp \
+        qwt_raster_tile_scheduler.cpp \
         qwt_matrix_raster_data.cpp \
+        qwt_waterfall_raster_data.cpp \
         qwt_sampling_thread.cpp \
         qwt_series_data.cpp \
         qwt_point_data.cpp \
+        qwt_mapped_point_data.cpp \
+        qwt_circular_point_data.cpp \
         qwt_scale_widget.cpp 
 }
 